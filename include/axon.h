@@ -89,6 +89,7 @@ then using the AXON_API_VISIBILITY flag to "export" the same symbols the way AXO
 #include <stdint.h>
 #include <stdbool.h>
 #include <semaphore.h>
+#include <sys/types.h>
 
 #include "amp.h"
 
@@ -106,25 +107,71 @@ typedef enum {
     AXON_TYPE_REP /* Replier (server waiting for message from clients and replying to the client OR client waiting for message from servers and replying to the server) */
 } axon_enum_e;
 
-/* Axon topic subscription */
-struct axon_s;
-typedef struct axon_sub_s {
-    struct axon_sub_s *next;                                         /* Next subscription */
-    char *             topic;                                        /* Topic of the subscription */
-    amp_msg_t *(*fct)(struct axon_s *, char *, amp_msg_t *, void *); /* Callback function invoked when topic is received */
-    void *user;                                                      /* User data passed to the callback */
-} axon_sub_t;
+/* Additional field type of axon_send, axon_vsend and axon_reply, serialized JSON given as a char * and its size as an int, sent unchanged as a JSON field */
+#define AXON_TYPE_JSON_RAW ((amp_type_e)0x100)
+
+/* Maximum amount of fields of a message */
+#define AXON_FIELDS_MAX 15
+
+/* Axon message field, view of the data in the received buffer */
+struct cJSON;
+typedef struct {
+    amp_type_e    type; /* Type of the field */
+    void *        data; /* Data of the field without type prefix, strings, big integers and JSON are not null-terminated */
+    size_t        size; /* Size of the data */
+    struct cJSON *json; /* JSON tree parsed on the first call to axon_msg_get_json, NULL until then */
+} axon_field_t;
+
+/* Axon message given to the callbacks when the "zero copy" option is set, valid until the callback returns unless it is retained */
+typedef struct axon_buffer_s axon_buffer_t;
+typedef struct axon_msg_s {
+    unsigned int   count;                   /* Amount of fields */
+    axon_field_t   fields[AXON_FIELDS_MAX]; /* Fields */
+    void *         frame;                   /* Encoded message as received, which can be forwarded with axon_send_encoded */
+    size_t         frame_size;              /* Size of the encoded message */
+    axon_buffer_t *buffer;                  /* Received buffer holding the data of the fields */
+} axon_msg_t;
+
+/* Axon stream events, given to the "stream" callback while a message is received */
+typedef enum {
+    AXON_STREAM_BEGIN, /* A message begins, count is set */
+    AXON_STREAM_FIELD, /* A field begins, index, type and size are set */
+    AXON_STREAM_DATA,  /* Data of the current field are received, data, length and offset are set */
+    AXON_STREAM_END,   /* The message is complete */
+    AXON_STREAM_ABORT  /* The connection is lost or the data received are invalid before the message is complete */
+} axon_stream_event_e;
+
+/* Axon stream, state of the message being received given to the "stream" callback */
+typedef struct {
+    axon_stream_event_e event;   /* Event */
+    unsigned int        count;   /* Amount of fields of the message */
+    unsigned int        index;   /* Index of the current field */
+    amp_type_e          type;    /* Type of the current field */
+    size_t              size;    /* Size of the data of the current field, without type prefix */
+    size_t              offset;  /* Offset of the data received in the current field */
+    void *              data;    /* Data received, valid until the callback returns */
+    size_t              length;  /* Size of the data received */
+    void *              context; /* Free for use by the callback, NULL when the message begins */
+} axon_stream_t;
+
+/* Axon messages builder, encoding the fields of the messages directly in a buffer reused from one message to the next */
+typedef struct axon_msg_builder_s axon_msg_builder_t;
 
 /* Axon instance */
 typedef struct sock_s sock_t;
+typedef struct subs_s subs_t;
+typedef struct stream_s stream_t;
 typedef struct axon_s {
-    axon_enum_e  type;   /* Axon instance type */
-    sock_t *     sock;   /* Sock instance */
-    unsigned int msg_id; /* Requester message ID used to retrieve response */
+    axon_enum_e  type;    /* Axon instance type */
+    sock_t *     sock;    /* Sock instance */
+    subs_t *     subs;    /* Topic subscriptions */
+    stream_t **  streams; /* Stream parsers indexed by socket, NULL if the stream callback is not registered */
+    unsigned int msg_id;  /* Requester message ID used to retrieve response */
     struct {
-        axon_sub_t *first; /* Topic subscription daisy chain */
-        sem_t       sem;   /* Semaphore used to protect daisy chain */
-    } subs;
+        bool glob;          /* Subscriptions topics are glob patterns instead of regular expressions */
+        bool zero_copy;     /* Messages are given to the callbacks as views in the received buffer instead of decoded AMP messages */
+        bool json_validate; /* Serialized JSON fields are validated before being sent */
+    } options;
     struct {
         struct {
             void *(*fct)(struct axon_s *, uint16_t, void *); /* Callback function invoked when socket is bound */
@@ -134,10 +181,18 @@ typedef struct axon_s {
             amp_msg_t *(*fct)(struct axon_s *, amp_msg_t *, void *); /* Callback function invoked when message is received */
             void *user;                                              /* User data passed to the callback */
         } message;
+        struct {
+            amp_msg_t *(*fct)(struct axon_s *, axon_msg_t *, void *); /* Callback function invoked when message is received with the "zero copy" option */
+            void *user;                                               /* User data passed to the callback */
+        } view;
         struct {
             void *(*fct)(struct axon_s *, char *, void *); /* Callback function invoked when an error occurs */
             void *user;                                    /* User data passed to the callback */
         } error;
+        struct {
+            void (*fct)(struct axon_s *, axon_stream_t *, void *); /* Callback function invoked while a message is received, instead of the message and subscriptions callbacks */
+            void *user;                                            /* User data passed to the callback */
+        } stream;
     } cb;
 } axon_t;
 
@@ -163,12 +218,69 @@ AXON_PUBLIC(int) axon_bind(axon_t *axon, uint16_t port);
 /**
  * @brief Connect axon to the wanted host and port
  * @param axon Axon instance
- * @param hostname Hostname
+ * @param hostname Hostname, IPv4 or IPv6 address
  * @param port Port
  * @return 0 if the function succeeded, -1 otherwise
  */
 AXON_PUBLIC(int) axon_connect(axon_t *axon, char *hostname, uint16_t port);
 
+/**
+ * @brief Bind axon on the wanted Unix domain socket path
+ * @param axon Axon instance
+ * @param path Path of the socket, shorter than the path of a Unix domain socket address, an existing socket file is removed
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_bind_ipc(axon_t *axon, char *path);
+
+/**
+ * @brief Connect axon to the wanted Unix domain socket path
+ * @param axon Axon instance
+ * @param path Path of the socket, shorter than the path of a Unix domain socket address
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_connect_ipc(axon_t *axon, char *path);
+
+/**
+ * @brief Create a shared memory ring linking axon to a peer of the same host, Publisher and Pusher write to the ring, Subscriber and Puller read from it
+ * @param axon Axon instance
+ * @param name Name of the ring, starting with '/', an existing ring is replaced
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_bind_shm(axon_t *axon, char *name);
+
+/**
+ * @brief Open a shared memory ring created by a peer of the same host, the ring is opened as soon as the peer has created it
+ * @param axon Axon instance
+ * @param name Name of the ring, starting with '/'
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_connect_shm(axon_t *axon, char *name);
+
+/**
+ * @brief Create an in-process queue linking axon to a peer of the same process, Publisher and Pusher write to the queue, Subscriber and Puller read from it
+ * @param axon Axon instance
+ * @param name Name of the queue, unique in the process
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_bind_inproc(axon_t *axon, char *name);
+
+/**
+ * @brief Open an in-process queue created by a peer of the same process, the queue is opened as soon as the peer has created it
+ * @param axon Axon instance
+ * @param name Name of the queue
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_connect_inproc(axon_t *axon, char *name);
+
+/**
+ * @brief Bind axon to a UDP multicast group, Publisher sends each message once to the group and Subscriber joins the group to receive them
+ * @param axon Axon instance
+ * @param group IPv4 address of the multicast group
+ * @param port Port of the group
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_bind_multicast(axon_t *axon, char *group, uint16_t port);
+
 /**
  * @brief Check if axon is already connected to the wanted host and port
  * @param axon Axon instance
@@ -188,6 +300,15 @@ AXON_PUBLIC(bool) axon_is_connected(axon_t *axon, char *hostname, uint16_t port)
  */
 AXON_PUBLIC(int) axon_on(axon_t *axon, char *topic, void *fct, void *user);
 
+/**
+ * @brief Set option, should be called before binding or connecting the instance
+ * @param axon Axon instance
+ * @param name Option name
+ * @param ... Option value
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_set(axon_t *axon, char *name, ...);
+
 /**
  * @brief Subscribe to wanted topic
  * @param axon Axon instance
@@ -198,6 +319,16 @@ AXON_PUBLIC(int) axon_on(axon_t *axon, char *topic, void *fct, void *user);
  */
 AXON_PUBLIC(int) axon_subscribe(axon_t *axon, char *topic, void *fct, void *user);
 
+/**
+ * @brief Subscribe to wanted topic, the callback is invoked with the messages viewed in the received buffer when the "zero copy" option is set
+ * @param axon Axon instance
+ * @param topic Topic
+ * @param fct Callback funtion
+ * @param user User data
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_subscribe_view(axon_t *axon, char *topic, void *fct, void *user);
+
 /**
  * @brief Unubscribe to wanted topic
  * @param axon Axon instance
@@ -228,6 +359,33 @@ AXON_PUBLIC(int) axon_send(axon_t *axon, int count, amp_type_e type1, void *valu
  */
 AXON_PUBLIC(int) axon_vsend(axon_t *axon, int count, amp_type_e type1, void *value1, va_list params);
 
+/**
+ * @brief Function used to send the message encoded by a messages builder to the server or to all connected clients, the builder is reset
+ * @param axon Axon instance
+ * @param builder Messages builder
+ * @param ... AMP response message and timeout for Requester instance
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_send_msg(axon_t *axon, axon_msg_builder_t *builder, ...);
+
+/**
+ * @brief Function used to send already encoded messages to the server or to all connected clients, they are sent unchanged after their framing is checked
+ * @param axon Axon instance
+ * @param buffer Encoded messages, one or more complete AMP frames
+ * @param size Size of the encoded messages
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_send_encoded(axon_t *axon, void *buffer, size_t size);
+
+/**
+ * @brief Function used to send a batch of messages to the server or to all connected clients, they are encoded in contiguous buffers sent at once
+ * @param axon Axon instance
+ * @param msgs AMP messages, they are not released
+ * @param count Amount of messages
+ * @return Amount of messages queued, the first ones of the batch, count if the function succeeded, -1 if the instance is not compatible or if memory can't be allocated
+ */
+AXON_PUBLIC(int) axon_send_batch(axon_t *axon, amp_msg_t **msgs, size_t count);
+
 /**
  * @brief Function used by Replier instance to format response to the server or to a single client
  * @param axon Axon instance
@@ -237,6 +395,97 @@ AXON_PUBLIC(int) axon_vsend(axon_t *axon, int count, amp_type_e type1, void *val
  */
 AXON_PUBLIC(amp_msg_t *) axon_reply(axon_t *axon, int count, ...);
 
+/**
+ * @brief Function used to create a messages builder
+ * @return Messages builder if the function succeeded, NULL otherwise
+ */
+AXON_PUBLIC(axon_msg_builder_t *) axon_msg_builder_create(void);
+
+/**
+ * @brief Reset the messages builder to encode a new message, the encode buffer is kept and the files are closed
+ * @param builder Messages builder
+ */
+AXON_PUBLIC(void) axon_msg_builder_reset(axon_msg_builder_t *builder);
+
+/**
+ * @brief Add a blob field to the message
+ * @param builder Messages builder
+ * @param blob Blob
+ * @param size Size of the blob
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_msg_builder_add_blob(axon_msg_builder_t *builder, void *blob, size_t size);
+
+/**
+ * @brief Add a string field to the message
+ * @param builder Messages builder
+ * @param str String
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_msg_builder_add_string(axon_msg_builder_t *builder, char *str);
+
+/**
+ * @brief Add a big integer field to the message
+ * @param builder Messages builder
+ * @param value Big integer
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_msg_builder_add_bigint(axon_msg_builder_t *builder, int64_t value);
+
+/**
+ * @brief Add a JSON field to the message
+ * @param builder Messages builder
+ * @param json JSON tree
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_msg_builder_add_json(axon_msg_builder_t *builder, struct cJSON *json);
+
+/**
+ * @brief Add a serialized JSON field to the message, it is written unchanged without being validated
+ * @param builder Messages builder
+ * @param json Serialized JSON
+ * @param size Size of the serialized JSON
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_msg_builder_add_json_raw(axon_msg_builder_t *builder, char *json, size_t size);
+
+/**
+ * @brief Add a blob field whose data are sent from a file without being read (sendfile), the file is duplicated and can be closed by the caller
+ * @param builder Messages builder
+ * @param fd File descriptor
+ * @param offset Offset of the data in the file
+ * @param size Size of the data
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+AXON_PUBLIC(int) axon_msg_builder_add_file(axon_msg_builder_t *builder, int fd, off_t offset, size_t size);
+
+/**
+ * @brief Release messages builder
+ * @param builder Messages builder
+ */
+AXON_PUBLIC(void) axon_msg_builder_release(axon_msg_builder_t *builder);
+
+/**
+ * @brief Retain a message received with the "zero copy" option so that it remains valid after the callback returns
+ * @param msg Message given to the callback
+ * @return Retained message if the function succeeded, NULL otherwise
+ */
+AXON_PUBLIC(axon_msg_t *) axon_msg_retain(axon_msg_t *msg);
+
+/**
+ * @brief Retrieve the JSON tree of a field of a message received with the "zero copy" option, the field is parsed on the first call only
+ * @param msg Message
+ * @param index Index of the field
+ * @return JSON tree owned by the message if the function succeeded, NULL if the field is not a valid JSON field
+ */
+AXON_PUBLIC(struct cJSON *) axon_msg_get_json(axon_msg_t *msg, unsigned int index);
+
+/**
+ * @brief Release a retained message
+ * @param msg Retained message
+ */
+AXON_PUBLIC(void) axon_msg_release(axon_msg_t *msg);
+
 /**
  * @brief Release axon instance
  * @param axon Axon instance
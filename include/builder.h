@@ -0,0 +1,108 @@
+/**
+ * @file      builder.h
+ * @brief     Messages builder encoding fields directly in a reusable buffer
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __BUILDER_H__
+#define __BUILDER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "axon.h"
+#include "sock.h"
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Initial capacity of the encode buffer */
+#define BUILDER_CAPACITY 256
+
+/* Messages builder structure */
+struct axon_msg_builder_s {
+    uint8_t *    buffer;                 /* Encode buffer, the frame header is written when the buffer is detached */
+    size_t       start;                  /* Position of the frame header of the message being encoded, several messages may be encoded one after the other */
+    size_t       size;                   /* Size of the encoded messages */
+    size_t       capacity;               /* Capacity of the encode buffer, kept as a hint for the next message when the buffer is detached */
+    unsigned int count;                  /* Amount of fields */
+    sock_file_t  files[AXON_FIELDS_MAX]; /* Parts of files sent after their field header, their data are not copied in the encode buffer */
+    unsigned int files_count;            /* Amount of parts of files */
+};
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Add a field to the message
+ * @param builder Messages builder
+ * @param prefix Prefix of the field, NULL for blobs
+ * @param data Data of the field
+ * @param size Size of the data
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int builder_add(axon_msg_builder_t *builder, const char *prefix, const void *data, size_t size);
+
+/**
+ * @brief Encode an AMP message in the builder, its fields are walked and written to the encode buffer as if they were added one by one
+ * @param builder Messages builder
+ * @param amp AMP message, it is not released
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int builder_encode(axon_msg_builder_t *builder, amp_msg_t *amp);
+
+/**
+ * @brief Complete the message being encoded and begin the next one after it in the same encode buffer, so that several messages are sent at once
+ * @param builder Messages builder
+ * @return 0 if the function succeeded, -1 if the message has no field or if memory can not be allocated
+ */
+int builder_next(axon_msg_builder_t *builder);
+
+/**
+ * @brief Detach the encoded message from the builder, the builder is reset and allocates a new buffer for the next message
+ * @param builder Messages builder
+ * @param buffer Encoded messages, to be released by the caller
+ * @param size Size of the encoded messages
+ * @param files Parts of files sent within the encoded message, to be released by the caller, NULL if there is none
+ * @param count Amount of parts of files
+ * @return 0 if the function succeeded, -1 if the message has no field or if memory can not be allocated
+ */
+int builder_detach(axon_msg_builder_t *builder, void **buffer, size_t *size, sock_file_t **files, size_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BUILDER_H__ */
@@ -0,0 +1,116 @@
+/**
+ * @file      cache.h
+ * @brief     Topic match cache used to dispatch frequent topics with a single lookup
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __CACHE_H__
+#define __CACHE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Cache entry, never modified once it has been stored */
+typedef struct {
+    uint64_t     hash;       /* Hash of the topic */
+    unsigned int generation; /* Generation of the subscriptions table used to compute the matches */
+    size_t       size;       /* Size of the topic */
+    char *       topic;      /* Topic, stored after the matches */
+    size_t       count;      /* Amount of matching subscriptions */
+    size_t       matches[];  /* Indexes of the matching subscriptions */
+} cache_entry_t;
+
+/* Cache slot */
+typedef struct {
+    atomic_flag    lock;  /* Lock of the slot, held only while the entry is compared, copied or replaced */
+    cache_entry_t *entry; /* Entry, NULL if the slot is empty */
+} cache_slot_t;
+
+/* Cache instance structure, a direct-mapped table of topics and their matching subscriptions */
+typedef struct {
+    size_t        mask;  /* Amount of slots minus one, the amount of slots is a power of 2 */
+    cache_slot_t *slots; /* Slots */
+} cache_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a cache instance
+ * @param size Amount of topics, rounded up to a power of 2
+ * @return Cache instance if the function succeeded, NULL otherwise
+ */
+cache_t *cache_create(size_t size);
+
+/**
+ * @brief Search the matching subscriptions of a topic
+ * @param cache Cache instance
+ * @param generation Generation of the subscriptions table, entries of other generations are ignored
+ * @param topic Topic
+ * @param size Size of the topic
+ * @param matches Array filled with the indexes of the matching subscriptions
+ * @param count Amount of matching subscriptions
+ * @return true if the topic has been found, false otherwise
+ */
+bool cache_lookup(cache_t *cache, unsigned int generation, char *topic, size_t size, size_t *matches, size_t *count);
+
+/**
+ * @brief Store the matching subscriptions of a topic, replacing the topic previously stored in the same slot
+ * @param cache Cache instance
+ * @param generation Generation of the subscriptions table
+ * @param topic Topic
+ * @param size Size of the topic
+ * @param matches Indexes of the matching subscriptions
+ * @param count Amount of matching subscriptions
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int cache_insert(cache_t *cache, unsigned int generation, char *topic, size_t size, size_t *matches, size_t count);
+
+/**
+ * @brief Release cache instance
+ * @param cache Cache instance
+ */
+void cache_release(cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CACHE_H__ */
@@ -0,0 +1,138 @@
+/**
+ * @file      dfa.h
+ * @brief     Combined deterministic automaton matching several regular expressions at once
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __DFA_H__
+#define __DFA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <semaphore.h>
+
+#include "nfa.h"
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Maximum amount of DFA states, topics requiring more states are not matched by the automaton */
+#define DFA_STATES_MAX 8192
+
+/* DFA state structure, never modified once it has been created except the transitions which are built when they are first used */
+typedef struct {
+    int *      nfa;               /* NFA states, sorted */
+    size_t     count;             /* Amount of NFA states */
+    size_t *   accepts;           /* Indexes of the patterns matching when the state is entered */
+    size_t     accepts_count;     /* Amount of patterns matching when the state is entered */
+    size_t *   accepts_end;       /* Indexes of the patterns matching if the topic ends in the state */
+    size_t     accepts_end_count; /* Amount of patterns matching if the topic ends in the state */
+    atomic_int next[];            /* Next state for each class of characters, -1 if it has not been built yet */
+} dfa_state_t;
+
+/* DFA instance structure, subset construction of the union of the patterns performed lazily while matching topics */
+typedef struct {
+    nfa_state_t * states;            /* NFA states of all the patterns */
+    int *         owners;            /* Pattern of each NFA state */
+    size_t        count;             /* Amount of NFA states */
+    uint8_t       classes[256];      /* Class of each character, characters of a class are never distinguished by the patterns */
+    size_t        classes_count;     /* Amount of classes of characters */
+    size_t        capacity;          /* Capacity of the NFA states arrays */
+    int *         starts;            /* Start state of each pattern */
+    size_t *      indexes;           /* Index given when each pattern has been added */
+    size_t        patterns_count;    /* Amount of patterns */
+    size_t        patterns_capacity; /* Capacity of the patterns arrays */
+    int *         inject;            /* NFA states entered at each character of the topic, so that patterns are searched anywhere in the topic */
+    size_t        inject_count;      /* Amount of NFA states entered at each character of the topic */
+    dfa_state_t **cache;             /* DFA states, the first one is the initial state */
+    size_t        cache_count;       /* Amount of DFA states */
+    int *         hash;              /* Hash table of the DFA states, -1 for empty slots */
+    unsigned int *marks;             /* Marks of the NFA states visited by the current closure */
+    unsigned int *owners_marks;      /* Marks of the patterns accepted by the current DFA state */
+    unsigned int  mark;              /* Current mark */
+    int *         stack;             /* Stack of the current closure */
+    int *         seeds;             /* NFA states from which the current closure is computed */
+    int *         set;               /* NFA states of the current closure */
+    size_t *      accepts;           /* Patterns accepted by the current DFA state */
+    sem_t         sem;               /* Semaphore used to serialize the creation of DFA states */
+} dfa_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a DFA instance
+ * @return DFA instance if the function succeeded, NULL otherwise
+ */
+dfa_t *dfa_create(void);
+
+/**
+ * @brief Add a pattern to the DFA, dfa_build must be called once all the patterns are added
+ * @param dfa DFA instance
+ * @param nfa Pattern compiled to a NFA instance
+ * @param index Index returned when the pattern matches
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int dfa_add(dfa_t *dfa, nfa_t *nfa, size_t index);
+
+/**
+ * @brief Build the initial state of the DFA, other states are built when they are first used
+ * @param dfa DFA instance
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int dfa_build(dfa_t *dfa);
+
+/**
+ * @brief Search all the patterns of the DFA in the topic, the function can be called from several threads at the same time
+ * @param dfa DFA instance
+ * @param topic Topic
+ * @param size Size of the topic
+ * @param matches Array to which the indexes of the matching patterns are appended, each index is appended only once
+ * @param count Amount of indexes in the array, updated if the function succeeded
+ * @return 0 if the function succeeded, -1 if the maximum amount of DFA states is reached
+ */
+int dfa_match(dfa_t *dfa, char *topic, size_t size, size_t *matches, size_t *count);
+
+/**
+ * @brief Release DFA instance
+ * @param dfa DFA instance
+ */
+void dfa_release(dfa_t *dfa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DFA_H__ */
@@ -0,0 +1,138 @@
+/**
+ * @file      executor.h
+ * @brief     Work-stealing executor used to dispatch messages
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __EXECUTOR_H__
+#define __EXECUTOR_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <pthread.h>
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Amount of strands used to serialize tasks sharing the same key */
+#define EXECUTOR_STRANDS 1024
+
+/* Executor task structure */
+typedef struct {
+    void (*fct)(void *); /* Function invoked to run the task */
+    void *arg;           /* Argument passed to the function */
+} executor_task_t;
+
+/* Executor strand node structure */
+typedef struct executor_node_s {
+    struct executor_node_s *next; /* Next node */
+    executor_task_t         task; /* Task waiting to be run */
+} executor_node_t;
+
+/* Executor strand structure, tasks sharing the same key are run one after the other in submission order */
+typedef struct {
+    executor_node_t *first;     /* First task waiting to be run */
+    executor_node_t *last;      /* Last task waiting to be run */
+    bool             scheduled; /* Strand is queued or running on a worker */
+    sem_t            sem;       /* Semaphore used to protect the strand */
+} executor_strand_t;
+
+/* Executor worker structure */
+struct executor_s;
+typedef struct {
+    struct executor_s *parent; /* Parent executor instance */
+    pthread_t          thread; /* Thread handle of the worker */
+    int                cpu;    /* CPU on which the worker is pinned, -1 if the worker is not pinned */
+    struct {
+        executor_task_t *tasks;    /* Circular buffer of tasks, the worker pops the oldest task and thieves steal the newest one */
+        size_t           head;     /* Index of the oldest task */
+        size_t           count;    /* Amount of tasks */
+        size_t           capacity; /* Capacity of the circular buffer */
+        sem_t            sem;      /* Semaphore used to protect the deque */
+    } deque;
+} executor_worker_t;
+
+/* Executor instance structure */
+typedef struct executor_s {
+    executor_worker_t *workers; /* Workers */
+    int                count;   /* Amount of workers */
+    atomic_uint        next;    /* Index of the worker receiving the next submitted task */
+    atomic_bool        stop;    /* Flag used to stop the workers */
+    sem_t              pending; /* Semaphore counting the tasks not yet picked by a worker */
+    executor_strand_t *strands; /* Strands */
+} executor_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create an executor instance
+ * @param count Amount of workers
+ * @return Executor instance if the function succeeded, NULL otherwise
+ */
+executor_t *executor_create(int count);
+
+/**
+ * @brief Pin each worker on one of the wanted CPUs
+ * @param executor Executor instance
+ * @param cpus CPUs on which the workers are distributed, empty set to unpin the workers
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int executor_set_affinity(executor_t *executor, cpu_set_t *cpus);
+
+/**
+ * @brief Submit a task to the executor
+ * @param executor Executor instance
+ * @param key Tasks submitted with the same non-negative key are run one after the other in submission order, -1 if the task can be run at any time
+ * @param cpu Preferred CPU, the task is queued to the worker pinned on this CPU if any, -1 if there is no preference
+ * @param fct Function invoked to run the task
+ * @param arg Argument passed to the function
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int executor_submit(executor_t *executor, int key, int cpu, void (*fct)(void *), void *arg);
+
+/**
+ * @brief Release executor instance, pending tasks are run before the workers are stopped
+ * @param executor Executor instance
+ */
+void executor_release(executor_t *executor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EXECUTOR_H__ */
@@ -0,0 +1,110 @@
+/**
+ * @file      frame.h
+ * @brief     AMP frames parsing without decoding
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __FRAME_H__
+#define __FRAME_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "amp.h"
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* AMP wire format, a header byte holding the version and the amount of fields followed by each field size (big endian) and data */
+#define FRAME_VERSION           1  /* Protocol version */
+#define FRAME_HEADER_SIZE       1  /* Size of the frame header */
+#define FRAME_FIELD_HEADER_SIZE 4  /* Size of the field header */
+#define FRAME_FIELDS_MAX        15 /* Maximum amount of fields */
+
+/* Prefixes of the fields data depending of their type, blobs have no prefix */
+#define FRAME_PREFIX_SIZE   2    /* Size of the prefixes */
+#define FRAME_PREFIX_STRING "s:" /* String prefix */
+#define FRAME_PREFIX_BIGINT "n:" /* Big integer prefix */
+#define FRAME_PREFIX_JSON   "j:" /* JSON prefix */
+
+/* Field view, data points into the frame */
+typedef struct {
+    amp_type_e type; /* Type of the field */
+    uint8_t *  data; /* Data of the field, without prefix */
+    size_t     size; /* Size of the data */
+} frame_field_t;
+
+/* Frame structure */
+typedef struct {
+    size_t        size;                     /* Size of the whole frame */
+    unsigned int  count;                    /* Amount of fields */
+    frame_field_t fields[FRAME_FIELDS_MAX]; /* Fields views, only the first one is filled when the frame is peeked */
+} frame_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Parse the header of the frame at the beginning of a buffer, only the fields headers are read
+ * @param buffer Buffer
+ * @param size Size of the buffer
+ * @param frame Frame filled with the size of the frame and a view of its first field
+ * @return 0 if the buffer begins with a complete frame, -1 otherwise
+ */
+int frame_peek(void *buffer, size_t size, frame_t *frame);
+
+/**
+ * @brief Parse the frame at the beginning of a buffer, all the fields are viewed in place without copy
+ * @param buffer Buffer
+ * @param size Size of the buffer
+ * @param frame Frame filled with the size of the frame and the views of all its fields
+ * @return 0 if the buffer begins with a complete frame, -1 otherwise
+ */
+int frame_parse(void *buffer, size_t size, frame_t *frame);
+
+/**
+ * @brief Retrieve the type of a field using its prefix
+ * @param data Data of the field, including the prefix
+ * @param size Size of the data
+ * @param field Field view filled with the type and the data without prefix
+ */
+void frame_field(uint8_t *data, size_t size, frame_field_t *field);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAME_H__ */
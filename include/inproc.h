@@ -0,0 +1,118 @@
+/**
+ * @file      inproc.h
+ * @brief     In-process queue carrying frames between instances of the same process
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __INPROC_H__
+#define __INPROC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Node of the queue, holding the data of one write */
+typedef struct inproc_node_s {
+    _Atomic(struct inproc_node_s *) next;   /* Next node, NULL if it is the last one */
+    void *                          buffer; /* Data, owned by the queue until they are read */
+    size_t                          size;   /* Size of the data */
+} inproc_node_t;
+
+/* Queue instance, registered by name in the process, any amount of producers and a single consumer */
+typedef struct inproc_s {
+    struct inproc_s *        next;     /* Next registered queue */
+    char *                   name;     /* Name of the queue */
+    atomic_int               refcount; /* Amount of references, one per instance using the queue */
+    bool                     removed;  /* Queue has been removed from the registry */
+    atomic_bool              consumer; /* Queue is read by an instance, there is a single consumer */
+    _Atomic(inproc_node_t *) tail;     /* Last node, where the producers append their data */
+    uint8_t                  pad0[64]; /* Padding, producers and consumer positions are on distinct cache lines */
+    inproc_node_t *          head;     /* Node preceding the first data to read, only modified by the consumer */
+    _Atomic uint32_t         signal;   /* Futex word incremented each time data are written */
+    _Atomic uint32_t         waiting;  /* Consumer is waiting on the futex word */
+} inproc_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a queue and to register it in the process
+ * @param name Name of the queue
+ * @return Queue instance if the function succeeded, NULL if the name is already registered or on error
+ */
+inproc_t *inproc_create(char *name);
+
+/**
+ * @brief Function used to open a queue registered in the process
+ * @param name Name of the queue
+ * @return Queue instance if the function succeeded, NULL if the queue is not registered yet
+ */
+inproc_t *inproc_open(char *name);
+
+/**
+ * @brief Write data to the queue, the data are not copied and the function never waits
+ * @param inproc Queue instance
+ * @param buffer Data to write, released with the queue if they are not read
+ * @param size Size of the data
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int inproc_write(inproc_t *inproc, void *buffer, size_t size);
+
+/**
+ * @brief Read the oldest data written to the queue, the function waits if the queue is empty
+ * @param inproc Queue instance
+ * @param buffer Data read, to be released by the caller, NULL if there is none
+ * @param size Size of the data
+ * @param timeout Maximum time to wait in milliseconds
+ * @return 0 if the function succeeded, -1 if no data has been read
+ */
+int inproc_read(inproc_t *inproc, void **buffer, size_t *size, int timeout);
+
+/**
+ * @brief Release a reference of the queue, the queue is freed with its pending data when no instance uses it anymore
+ * @param inproc Queue instance
+ * @param remove true to remove the queue from the registry so that its name can be created again, false otherwise
+ */
+void inproc_release(inproc_t *inproc, bool remove);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INPROC_H__ */
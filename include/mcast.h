@@ -0,0 +1,143 @@
+/**
+ * @file      mcast.h
+ * @brief     UDP multicast group carrying frames from a publisher to the subscribers of a LAN
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __MCAST_H__
+#define __MCAST_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Default maximum size of the datagrams, including the header, so that they are not fragmented on Ethernet */
+#define MCAST_SIZE 1472
+
+/* Maximum size of a datagram, a frame larger than the wanted size is sent alone up to this size */
+#define MCAST_DATAGRAM_SIZE 65507
+
+/* Size of the datagram header, the session of the sender followed by the sequence number of the datagram (big endian) */
+#define MCAST_HEADER_SIZE 12
+
+/* Amount of datagrams sent or received with a single system call */
+#define MCAST_BATCH 16
+
+/* Amount of senders whose sequence numbers are followed by the receiver */
+#define MCAST_SOURCES 32
+
+/* Sender followed by the receiver */
+typedef struct {
+    uint32_t address;  /* Address of the sender, network byte order */
+    uint16_t port;     /* Port of the sender, network byte order */
+    uint32_t session;  /* Session of the sender, changed each time it is restarted */
+    uint64_t sequence; /* Next sequence number expected */
+    bool     used;     /* Entry is used */
+} mcast_source_t;
+
+/* Multicast instance */
+typedef struct {
+    int      socket;   /* UDP socket */
+    bool     sender;   /* Datagrams are sent to the group, they are received otherwise */
+    size_t   size;     /* Maximum size of the datagrams sent */
+    uint32_t session;  /* Session of the sender */
+    uint64_t sequence; /* Sequence number of the next datagram sent */
+    sem_t    sem;      /* Semaphore used to serialize the senders */
+    uint8_t *buffers;  /* Buffers of the datagrams received at once */
+    struct {
+        mcast_source_t entries[MCAST_SOURCES]; /* Senders, the oldest one is replaced when a new sender is detected */
+        unsigned int   next;                   /* Index of the entry replaced next */
+    } sources;
+} mcast_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a multicast instance sending datagrams to a group
+ * @param group IPv4 address of the multicast group
+ * @param port Destination port
+ * @param interface IPv4 address of the outgoing interface, NULL to use the default one
+ * @param ttl Time to live of the datagrams, 1 to stay on the local network
+ * @param loop true if the datagrams are also received by the subscribers of the host, false otherwise
+ * @param size Maximum size of the datagrams, including the header
+ * @return Multicast instance if the function succeeded, NULL otherwise
+ */
+mcast_t *mcast_create_sender(char *group, uint16_t port, char *interface, int ttl, bool loop, size_t size);
+
+/**
+ * @brief Function used to create a multicast instance receiving the datagrams sent to a group
+ * @param group IPv4 address of the multicast group
+ * @param port Port on which the datagrams are received
+ * @param interface IPv4 address of the interface joining the group, NULL to use the default one
+ * @return Multicast instance if the function succeeded, NULL otherwise
+ */
+mcast_t *mcast_create_receiver(char *group, uint16_t port, char *interface);
+
+/**
+ * @brief Send frames to the group, they are packed in datagrams and never split
+ * @param mcast Multicast instance
+ * @param buffer Frames to send
+ * @param size Size of the frames
+ * @return 0 if the function succeeded, -1 otherwise, the frames too large for a datagram are skipped and the other ones are sent
+ */
+int mcast_send(mcast_t *mcast, void *buffer, size_t size);
+
+/**
+ * @brief Receive the datagrams available, the function waits if there is none
+ * @param mcast Multicast instance
+ * @param buffer Frames of the datagrams concatenated, to be released by the caller, NULL if there is none
+ * @param size Size of the frames
+ * @param lost Amount of datagrams lost detected using the sequence numbers
+ * @param timeout Maximum time to wait in milliseconds
+ * @return 0 if the function succeeded, -1 if no frame has been received
+ */
+int mcast_receive(mcast_t *mcast, void **buffer, size_t *size, uint64_t *lost, int timeout);
+
+/**
+ * @brief Release multicast instance
+ * @param mcast Multicast instance
+ */
+void mcast_release(mcast_t *mcast);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MCAST_H__ */
@@ -0,0 +1,110 @@
+/**
+ * @file      nfa.h
+ * @brief     Compilation of extended regular expressions to non-deterministic automatons
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __NFA_H__
+#define __NFA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Maximum amount of states of an automaton, bounded repetitions are expanded */
+#define NFA_STATES_MAX 4096
+
+/* Metacharacters of the extended regular expressions */
+#define NFA_METACHARACTERS ".[]()*+?{}|^$\\"
+
+/* Check if a character is part of the set of a char state */
+#define NFA_STATE_HAS(state, c) (0 != ((state)->set[(unsigned char)(c) >> 3] & (1 << ((unsigned char)(c)&7))))
+
+/* NFA state type */
+typedef enum {
+    NFA_TYPE_CHAR,  /* Consume a character of the set */
+    NFA_TYPE_EMPTY, /* Go to the next state without consuming a character */
+    NFA_TYPE_SPLIT, /* Go to both next states without consuming a character */
+    NFA_TYPE_BOL,   /* Go to the next state if at the beginning of the topic */
+    NFA_TYPE_EOL,   /* Go to the next state if at the end of the topic */
+    NFA_TYPE_MATCH  /* The pattern matches */
+} nfa_type_e;
+
+/* NFA state structure */
+typedef struct {
+    nfa_type_e type;    /* State type */
+    int        out;     /* Next state, -1 if there is none */
+    int        out1;    /* Second next state of split states, -1 if there is none */
+    uint8_t    set[32]; /* Characters consumed by char states, one bit per character */
+} nfa_state_t;
+
+/* NFA fragment structure, used during the compilation */
+typedef struct {
+    int start; /* Start state of the fragment */
+    int end;   /* End state of the fragment, an empty state without next state */
+} nfa_frag_t;
+
+/* NFA instance structure, Thompson's construction of a regular expression */
+typedef struct {
+    nfa_state_t *states;   /* States */
+    size_t       count;    /* Amount of states */
+    size_t       capacity; /* Capacity of the states array */
+    int          start;    /* Start state */
+} nfa_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to compile an extended regular expression to a NFA instance
+ * Supported syntax is characters, escaped metacharacters, '.', bracket expressions with ranges and character classes, groups, alternations, anchors and
+ * '*', '+', '?' and bounded repetitions. Other syntaxes are rejected so that the regular expression is executed using regexec instead.
+ * @param pattern Regular expression, it must have been compiled successfully using regcomp before
+ * @return NFA instance if the function succeeded, NULL otherwise
+ */
+nfa_t *nfa_create(char *pattern);
+
+/**
+ * @brief Release NFA instance
+ * @param nfa NFA instance
+ */
+void nfa_release(nfa_t *nfa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NFA_H__ */
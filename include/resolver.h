@@ -0,0 +1,129 @@
+/**
+ * @file      resolver.h
+ * @brief     Cache of the addresses of the hostnames, refreshed in the background
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __RESOLVER_H__
+#define __RESOLVER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/socket.h>
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Maximum amount of addresses kept for a hostname */
+#define RESOLVER_ADDRESSES 8
+
+/* Default interval at which the hostnames are resolved again in seconds */
+#define RESOLVER_REFRESH 60
+
+/* Resolved hostname, never removed once it has been added */
+typedef struct resolver_entry_s {
+    struct resolver_entry_s *next;                      /* Next entry */
+    char *                   hostname;                  /* Hostname, IPv4 or IPv6 address */
+    uint16_t                 port;                      /* Port */
+    bool                     numeric;                   /* Hostname is an address which is never resolved again */
+    bool                     expired;                   /* Addresses should be resolved again as soon as possible */
+    time_t                   refreshed;                 /* Time of the last resolution (CLOCK_MONOTONIC) in seconds */
+    size_t                   count;                     /* Amount of addresses, 0 if the hostname could not be resolved */
+    struct sockaddr_storage  addrs[RESOLVER_ADDRESSES]; /* Addresses, in the order given by the system resolver */
+    socklen_t                sizes[RESOLVER_ADDRESSES]; /* Sizes of the addresses */
+} resolver_entry_t;
+
+/* Resolver instance */
+typedef struct {
+    resolver_entry_t *first;   /* Resolved hostnames */
+    unsigned int      refresh; /* Interval at which the hostnames are resolved again in seconds */
+    pthread_t         thread;  /* Thread resolving the hostnames again, started with the first hostname which is not an address */
+    bool              started; /* Thread is started */
+    atomic_bool       stop;    /* Thread should stop */
+    sem_t             signal;  /* Semaphore used to wake up the thread when addresses have expired */
+    sem_t             sem;     /* Semaphore used to protect the entries */
+} resolver_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a resolver instance
+ * @return Resolver instance if the function succeeded, NULL otherwise
+ */
+resolver_t *resolver_create(void);
+
+/**
+ * @brief Set the interval at which the hostnames are resolved again
+ * @param resolver Resolver instance
+ * @param refresh Interval in seconds, 0 to use the default one
+ */
+void resolver_set_refresh(resolver_t *resolver, unsigned int refresh);
+
+/**
+ * @brief Retrieve the addresses of a hostname, only the first lookup of a hostname waits for the system resolver
+ * @param resolver Resolver instance
+ * @param hostname Hostname, IPv4 or IPv6 address
+ * @param port Port
+ * @param addrs Addresses filled by the function, at least RESOLVER_ADDRESSES entries
+ * @param sizes Sizes of the addresses filled by the function, at least RESOLVER_ADDRESSES entries
+ * @return Amount of addresses, 0 if the hostname can't be resolved
+ */
+size_t resolver_lookup(resolver_t *resolver, char *hostname, uint16_t port, struct sockaddr_storage *addrs, socklen_t *sizes);
+
+/**
+ * @brief Ask for the addresses of a hostname to be resolved again in the background, typically when none of them is reachable
+ * @param resolver Resolver instance
+ * @param hostname Hostname
+ * @param port Port
+ */
+void resolver_expire(resolver_t *resolver, char *hostname, uint16_t port);
+
+/**
+ * @brief Release resolver instance
+ * @param resolver Resolver instance
+ */
+void resolver_release(resolver_t *resolver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RESOLVER_H__ */
@@ -0,0 +1,145 @@
+/**
+ * @file      ring.h
+ * @brief     Shared memory ring carrying frames between processes of the same host
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __RING_H__
+#define __RING_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <semaphore.h>
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Default capacity of the rings */
+#define RING_SIZE (4 * 1024 * 1024)
+
+/* Default maximum time to wait for free space when writing to a full ring in milliseconds */
+#define RING_TIMEOUT (1000)
+
+/* Maximum amount of data read at once, unless the first record is larger */
+#define RING_READ_SIZE (64 * 1024)
+
+/* Header of the ring, shared between the processes, producer and consumer positions are on distinct cache lines */
+typedef struct {
+    uint32_t         magic;                                  /* Magic value, written once the ring is initialized */
+    uint32_t         size;                                   /* Capacity of the ring, power of two */
+    _Atomic uint32_t producer;                               /* Producer has claimed the ring */
+    _Atomic uint32_t consumer;                               /* Consumer has claimed the ring */
+    uint8_t          pad0[48];                               /* Padding */
+    _Atomic uint64_t head;                                   /* Write position, only modified by the producer */
+    _Atomic uint32_t signal;                                 /* Futex word incremented each time records are written */
+    uint8_t          pad1[52];                               /* Padding */
+    _Atomic uint64_t tail;                                   /* Read position, only modified by the consumer */
+    _Atomic uint32_t waiting;                                /* Consumer is waiting on the futex word */
+    _Atomic uint32_t freed;                                  /* Futex word incremented each time records are read or the consumer leaves */
+    _Atomic uint32_t full;                                   /* Producer is waiting on the freed futex word */
+    uint8_t          pad2[44];                               /* Padding */
+    uint8_t          data[] __attribute__((aligned(64)));    /* Records, a 4 bytes length followed by the data, aligned on 8 bytes */
+} ring_header_t;
+
+/* Ring instance, mapping of the ring in the process */
+typedef struct {
+    ring_header_t *header;   /* Shared ring */
+    size_t         size;     /* Size of the mapping */
+    char *         name;     /* Name of the shared memory object */
+    bool           claimed;  /* The instance has claimed a role in the ring */
+    bool           producer; /* Role claimed, producer or consumer */
+    sem_t          sem;      /* Semaphore used to serialize the producers of the process */
+} ring_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a ring, an existing ring with the same name is replaced
+ * @param name Name of the shared memory object, starting with '/'
+ * @param size Capacity of the ring, rounded up to a power of two
+ * @return Ring instance if the function succeeded, NULL otherwise
+ */
+ring_t *ring_create(char *name, size_t size);
+
+/**
+ * @brief Function used to open an existing ring
+ * @param name Name of the shared memory object, starting with '/'
+ * @return Ring instance if the function succeeded, NULL if the ring does not exist or is not initialized yet
+ */
+ring_t *ring_open(char *name);
+
+/**
+ * @brief Claim the producer or the consumer role of a ring, a ring links a single producer to a single consumer
+ * @param ring Ring instance
+ * @param producer true to claim the producer role, false to claim the consumer role
+ * @return 0 if the function succeeded, -1 if the role is already claimed by another instance
+ */
+int ring_claim(ring_t *ring, bool producer);
+
+/**
+ * @brief Write a record to the ring, the function waits while the ring is full
+ * @param ring Ring instance
+ * @param buffer Data to write
+ * @param size Size of the data
+ * @param timeout Maximum time to wait for free space in milliseconds
+ * @return 0 if the function succeeded, -1 if the data are too large for the ring, if the ring has no consumer or if it is still full after the timeout
+ */
+int ring_write(ring_t *ring, void *buffer, size_t size, int timeout);
+
+/**
+ * @brief Read the records available in the ring, the function waits if the ring is empty
+ * @param ring Ring instance
+ * @param buffer Data of the records concatenated, to be released by the caller, NULL if there is none
+ * @param size Size of the data
+ * @param timeout Maximum time to wait in milliseconds
+ * @return 0 if the function succeeded, -1 if no record has been read
+ */
+int ring_read(ring_t *ring, void **buffer, size_t *size, int timeout);
+
+/**
+ * @brief Release ring instance, the role claimed is given up
+ * @param ring Ring instance
+ * @param destroy true to remove the shared memory object, false to keep it for the peer
+ */
+void ring_release(ring_t *ring, bool destroy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RING_H__ */
@@ -37,8 +37,20 @@ extern "C" {
 /******************************************************************************/
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sched.h>
+#include <pthread.h>
 #include <semaphore.h>
 
+#include "executor.h"
+#include "ring.h"
+#include "inproc.h"
+#include "mcast.h"
+#include "resolver.h"
+
 /******************************************************************************/
 /* Definitions                                                                */
 /******************************************************************************/
@@ -47,6 +59,57 @@ extern "C" {
 #define SOCK_SEND_BROADCAST   -1 /* Send data to all connected clients and servers */
 #define SOCK_SEND_ROUND_ROBIN -2 /* Send data to the next connected client or server (Round-Robin mechanism) */
 
+/* Default maximum size of the data held before they are sent when micro-batching is enabled */
+#define SOCK_BATCH_SIZE 65536
+
+/* Sock file structure, part of a file sent at a given position of a buffer */
+typedef struct {
+    size_t position; /* Position in the buffer at which the data of the file are sent */
+    int    fd;       /* File descriptor, closed once the data are sent */
+    off_t  offset;   /* Offset of the data in the file */
+    size_t size;     /* Size of the data */
+} sock_file_t;
+
+/* Sock ring structure, shared memory ring linking the instance to a peer of the same host, or in-process queue linking the instance to a peer of the same process */
+struct sock_s;
+typedef struct sock_ring_s {
+    struct sock_ring_s *next;     /* Next ring */
+    struct sock_s *     parent;   /* Parent sock instance */
+    char *              name;     /* Name of the shared memory object or of the in-process queue */
+    bool                producer; /* Data are written to the ring, they are read from the ring otherwise */
+    bool                owner;    /* Ring is created by the instance and removed when the instance is released */
+    bool                local;    /* Ring is an in-process queue instead of a shared memory ring */
+    _Atomic(ring_t *)   ring;     /* Shared memory ring, NULL until it has been created by the peer */
+    _Atomic(inproc_t *) queue;    /* In-process queue, NULL until it has been created by the peer */
+    pthread_t           thread;   /* Thread opening the ring if it is created by the peer, and reading the ring if it is not a producer */
+    bool                started;  /* Thread is started */
+    atomic_bool         stop;     /* Thread should stop */
+} sock_ring_t;
+
+/* Sock batch structure, data sent to the same destination and held until they are flushed */
+typedef struct sock_batch_s {
+    struct sock_batch_s *next;     /* Next batch */
+    int                  socket;   /* Destination of the data, can be SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN */
+    uint8_t *            buffer;   /* Data held */
+    size_t               size;     /* Size of the data held */
+    size_t               capacity; /* Capacity of the buffer */
+    struct timespec      deadline; /* Date at which the data are flushed at the latest */
+} sock_batch_t;
+
+/* Sock hold structure, buffer of a sender kept until the completions of its zero-copy sends have been read */
+typedef struct {
+    void *       buffer;   /* Buffer of the sender */
+    unsigned int refcount; /* Amount of references, the sender and each zero-copy data in flight */
+} sock_hold_t;
+
+/* Sock zero-copy structure, data sent without copy to a socket and pinned by the kernel until the peer acknowledges them */
+typedef struct sock_zerocopy_s {
+    struct sock_zerocopy_s *next;   /* Next data in flight */
+    int                     socket; /* Socket to which the data have been sent */
+    uint32_t                last;   /* Identifier of the last zero-copy send of the data on the socket */
+    sock_hold_t *           hold;   /* Buffer of the data, released once all its sends are completed */
+} sock_zerocopy_t;
+
 /* Sock worker structure */
 struct sock_s;
 typedef struct sock_worker_s {
@@ -58,12 +121,14 @@ typedef struct sock_worker_s {
         struct {
             int      socket; /* Listenner socket */
             uint16_t port;   /* Listenner port */
+            char *   path;   /* Listenner path if it is a Unix domain socket, NULL otherwise */
             fd_set   fds;    /* Listenner FDs (myself + all connected clients) */
         } listenner;
         struct {
             int      socket;   /* Reader socket */
-            char *   hostname; /* Reader hostname */
+            char *   hostname; /* Reader hostname, or path if it is a Unix domain socket */
             uint16_t port;     /* Reader port */
+            bool     ipc;      /* Reader is a Unix domain socket */
             fd_set   fds;      /* Reader FDs (myself) */
         } reader;
         struct {
@@ -72,9 +137,12 @@ typedef struct sock_worker_s {
             size_t size;   /* Messenger buffer size */
         } messenger;
         struct {
-            int    socket; /* Sender socket, can be SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN */
-            void * buffer; /* Sender buffer */
-            size_t size;   /* Sender buffer size */
+            int          socket; /* Sender socket, can be SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN */
+            void *       buffer; /* Sender buffer */
+            size_t       size;   /* Sender buffer size */
+            sock_file_t *files;  /* Parts of files sent within the buffer, NULL if there is none */
+            size_t       count;  /* Amount of parts of files */
+            sock_hold_t *hold;   /* Buffer kept for the zero-copy sends in flight, NULL if there is none */
         } sender;
     } type;
 } sock_worker_t;
@@ -97,19 +165,87 @@ typedef struct sock_s {
         fd_set fds;   /* All clients sockets */
         sem_t  sem;   /* Semaphore used to protect clients */
     } clients;
+    executor_t *executor; /* Executor used to dispatch received data, NULL to start a messenger thread for each reception */
+    resolver_t *resolver; /* Cache of the addresses of the hostnames to which the readers connect */
+    struct {
+        sock_zerocopy_t *first;                 /* Data sent without copy whose completions have not been read yet */
+        fd_set           fds;                   /* Sockets on which zero-copy sends are enabled (SO_ZEROCOPY) */
+        uint32_t         sends[FD_SETSIZE];     /* Amount of zero-copy sends of each socket, the kernel identifies them in the same order */
+        uint32_t         completed[FD_SETSIZE]; /* Amount of zero-copy sends of each socket whose completion has been read */
+        sem_t            sem;                   /* Semaphore used to protect the zero-copy sends */
+    } zerocopy;
+    struct {
+        sock_ring_t *first; /* Shared memory rings */
+        unsigned int index; /* Round-Robin index */
+        sem_t        sem;   /* Semaphore used to protect rings */
+    } rings;
+    struct {
+        mcast_t *   mcast;   /* Multicast group, NULL if the instance is not bound to a group */
+        pthread_t   thread;  /* Thread receiving the datagrams if the instance is not a sender */
+        bool        started; /* Thread is started */
+        atomic_bool stop;    /* Thread should stop */
+    } multicast;
+    struct {
+        sock_batch_t *first;   /* Batches waiting to be flushed */
+        pthread_t     thread;  /* Thread flushing the batches when their deadline is reached */
+        bool          started; /* Flusher thread is started */
+        sem_t         signal;  /* Semaphore used to wake up the flusher thread when a new batch is created */
+        sem_t         sem;     /* Semaphore used to protect batches */
+    } batches;
+    struct {
+        bool   ordered;  /* Data received from the same socket are dispatched in order by the executor */
+        bool   spin;     /* Listenners and readers poll the sockets without sleeping and invoke the message callback inline */
+        bool   direct;   /* Listenners and readers invoke the message callback inline, data received are given in reception order */
+        size_t zerocopy; /* Minimum size of the data sent without copy (MSG_ZEROCOPY), 0 to always copy them */
+        struct {
+            cpu_set_t reader;   /* CPUs on which listenners and readers are running, empty set if not pinned */
+            cpu_set_t worker;   /* CPUs on which messengers, senders and executor workers are running, empty set if not pinned */
+            bool      incoming; /* Data received are handled on the CPU which received the packets (SO_INCOMING_CPU) */
+        } affinity;
+        struct {
+            bool nodelay;      /* Nagle algorithm is disabled (TCP_NODELAY) */
+            int  sndbuf;       /* Send buffer size (SO_SNDBUF), 0 to keep the system default */
+            int  rcvbuf;       /* Receive buffer size (SO_RCVBUF), 0 to keep the system default */
+            int  user_timeout; /* Maximum time transmitted data may remain unacknowledged in milliseconds (TCP_USER_TIMEOUT), 0 to keep the system default */
+            int  busy_poll;    /* Time spent busy polling the device queue on blocking reads in microseconds (SO_BUSY_POLL), 0 to disable it */
+            struct {
+                int idle;     /* Idle time before keepalive probes are sent in seconds (TCP_KEEPIDLE), 0 to disable keepalive */
+                int interval; /* Time between keepalive probes in seconds (TCP_KEEPINTVL), 0 to keep the system default */
+                int count;    /* Amount of unacknowledged probes before the connection is dropped (TCP_KEEPCNT), 0 to keep the system default */
+            } keepalive;
+        } tcp;
+        struct {
+            size_t size;    /* Capacity of the shared memory rings created by the instance */
+            int    timeout; /* Maximum time to wait for free space when writing to a full shared memory ring in milliseconds */
+        } ring;
+        struct {
+            unsigned int delay; /* Maximum time data are held before they are sent in microseconds, 0 to send them immediately */
+            size_t       size;  /* Maximum size of the data held before they are sent */
+        } batch;
+        struct {
+            int    ttl;       /* Time to live of the datagrams sent */
+            bool   loop;      /* Datagrams sent are also received by the subscribers of the host */
+            size_t size;      /* Maximum size of the datagrams sent */
+            char * interface; /* IPv4 address of the interface used to send and receive the datagrams, NULL to use the default one */
+        } multicast;
+    } options;
     struct {
         struct {
             void (*fct)(struct sock_s *, uint16_t, void *); /* Callback function invoked when socket is bound */
             void *user;                                     /* User data passed to the callback */
         } bind;
         struct {
-            void (*fct)(struct sock_s *, void *, size_t, int, void *); /* Callback function invoked when message is received */
+            void (*fct)(struct sock_s *, void *, size_t, int, void *); /* Callback function invoked when message is received, it takes the ownership of the buffer */
             void *user;                                                /* User data passed to the callback */
         } message;
         struct {
             void (*fct)(struct sock_s *, char *, void *); /* Callback function invoked when an error occured*/
             void *user;                                   /* User data passed to the callback */
         } error;
+        struct {
+            void (*fct)(struct sock_s *, int, void *); /* Callback function invoked when a client or server socket is closed by the listenner or reader */
+            void *user;                                /* User data passed to the callback */
+        } close;
     } cb;
 } sock_t;
 
@@ -134,12 +270,74 @@ int sock_bind(sock_t *sock, uint16_t port);
 /**
  * @brief Connect a new socket to the wanted host and port
  * @param sock Sock instance
- * @param hostname Hostname
+ * @param hostname Hostname, IPv4 or IPv6 address
  * @param port Port
  * @return 0 if the function succeeded, -1 otherwise
  */
 int sock_connect(sock_t *sock, char *hostname, uint16_t port);
 
+/**
+ * @brief Bind a new Unix domain socket to the wanted path
+ * @param sock Sock instance
+ * @param path Path of the socket, shorter than the path of a Unix domain socket address, an existing socket file is removed
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int sock_bind_ipc(sock_t *sock, char *path);
+
+/**
+ * @brief Connect a new Unix domain socket to the wanted path
+ * @param sock Sock instance
+ * @param path Path of the socket, shorter than the path of a Unix domain socket address
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int sock_connect_ipc(sock_t *sock, char *path);
+
+/**
+ * @brief Create a new shared memory ring linking the instance to a peer of the same host
+ * @param sock Sock instance
+ * @param name Name of the shared memory object, starting with '/', an existing ring is replaced
+ * @param producer true if data are sent to the ring, false if they are received from the ring
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int sock_bind_ring(sock_t *sock, char *name, bool producer);
+
+/**
+ * @brief Open a shared memory ring created by a peer of the same host, the ring is opened as soon as it is created
+ * @param sock Sock instance
+ * @param name Name of the shared memory object, starting with '/'
+ * @param producer true if data are sent to the ring, false if they are received from the ring
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int sock_connect_ring(sock_t *sock, char *name, bool producer);
+
+/**
+ * @brief Create a new in-process queue linking the instance to a peer of the same process
+ * @param sock Sock instance
+ * @param name Name of the queue, unique in the process
+ * @param producer true if data are sent to the queue, false if they are received from the queue
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int sock_bind_inproc(sock_t *sock, char *name, bool producer);
+
+/**
+ * @brief Open an in-process queue created by a peer of the same process, the queue is opened as soon as it is created
+ * @param sock Sock instance
+ * @param name Name of the queue
+ * @param producer true if data are sent to the queue, false if they are received from the queue
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int sock_connect_inproc(sock_t *sock, char *name, bool producer);
+
+/**
+ * @brief Bind the instance to a UDP multicast group, data broadcasted are sent to the group once whatever the amount of receivers
+ * @param sock Sock instance
+ * @param group IPv4 address of the multicast group
+ * @param port Port of the group
+ * @param producer true if data are sent to the group, false if they are received from the group
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int sock_bind_multicast(sock_t *sock, char *group, uint16_t port, bool producer);
+
 /**
  * @brief Check if sock is already connected to the wanted host and port
  * @param sock Sock instance
@@ -159,6 +357,15 @@ bool sock_is_connected(sock_t *sock, char *hostname, uint16_t port);
  */
 int sock_on(sock_t *sock, char *topic, void *fct, void *user);
 
+/**
+ * @brief Set option
+ * @param sock Sock instance
+ * @param name Option name
+ * @param params Option value
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int sock_vset(sock_t *sock, char *name, va_list params);
+
 /**
  * @brief Function used to send data
  * @param sock Sock instance
@@ -169,6 +376,25 @@ int sock_on(sock_t *sock, char *topic, void *fct, void *user);
  */
 int sock_send(sock_t *sock, void *buffer, size_t size, int socket);
 
+/**
+ * @brief Function used to send data with parts of files sent from the kernel without being read (sendfile)
+ * @param sock Sock instance
+ * @param buffer Buffer to be sent
+ * @param size Size of buffer to send
+ * @param files Parts of files sent within the buffer, ordered by position, the array and the file descriptors are released once they are sent
+ * @param count Amount of parts of files
+ * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @return 0 if the function succeeded, -1 otherwise, the buffer and the files are not released in this case
+ */
+int sock_send_files(sock_t *sock, void *buffer, size_t size, sock_file_t *files, size_t count, int socket);
+
+/**
+ * @brief Retrieve the amount of connected clients and servers
+ * @param sock Sock instance
+ * @return Amount of connected sockets and opened producer rings whose consumer is present
+ */
+int sock_count(sock_t *sock);
+
 /**
  * @brief Release sock instance
  * @param sock Sock instance
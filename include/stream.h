@@ -0,0 +1,105 @@
+/**
+ * @file      stream.h
+ * @brief     Incremental parsing of the received frames, fields data are streamed to the callback
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "axon.h"
+#include "frame.h"
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Stream parser states */
+typedef enum {
+    STREAM_STATE_HEADER,       /* Waiting for the frame header */
+    STREAM_STATE_FIELD_HEADER, /* Waiting for the field header */
+    STREAM_STATE_PREFIX,       /* Waiting for the field prefix */
+    STREAM_STATE_DATA          /* Receiving the field data */
+} stream_state_e;
+
+/* Stream parser of the frames received from a socket */
+typedef struct stream_s {
+    stream_state_e state;                            /* Parser state */
+    uint8_t        pending[FRAME_FIELD_HEADER_SIZE]; /* Bytes of the field header or prefix received so far */
+    size_t         pending_size;                     /* Amount of pending bytes */
+    size_t         length;                           /* Length of the current field, including the prefix */
+    size_t         remaining;                        /* Amount of data of the current field still to be received */
+    axon_stream_t  event;                            /* Event given to the callback, it holds the current message and field */
+} stream_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a stream parser
+ * @return Stream parser if the function succeeded, NULL otherwise
+ */
+stream_t *stream_create(void);
+
+/**
+ * @brief Parse data received, the stream callback of the Axon instance is invoked as soon as the headers and the data of the fields are received
+ * @param stream Stream parser
+ * @param axon Axon instance
+ * @param data Data received
+ * @param size Size of the data
+ * @return 0 if the function succeeded, -1 if the data are not a valid frame, the current message is aborted in this case
+ */
+int stream_feed(stream_t *stream, axon_t *axon, uint8_t *data, size_t size);
+
+/**
+ * @brief Abort the current message if any, the stream parser waits for a new frame
+ * @param stream Stream parser
+ * @param axon Axon instance
+ */
+void stream_abort(stream_t *stream, axon_t *axon);
+
+/**
+ * @brief Release stream parser
+ * @param stream Stream parser
+ */
+void stream_release(stream_t *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STREAM_H__ */
@@ -0,0 +1,185 @@
+/**
+ * @file      subs.h
+ * @brief     Handling of the topic subscriptions
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __SUBS_H__
+#define __SUBS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <semaphore.h>
+#include <regex.h>
+
+#include "amp.h"
+#include "cache.h"
+#include "trie.h"
+#include "nfa.h"
+#include "dfa.h"
+#include "wildcard.h"
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Amount of matching subscriptions which can be searched without allocating memory */
+#define SUBS_MATCHES 32
+
+/* Default amount of topics kept in the match cache */
+#define SUBS_CACHE_SIZE 4096
+
+/* Axon topic subscription, never modified once it has been added to a table */
+struct axon_s;
+struct axon_msg_s;
+typedef struct axon_sub_s {
+    char *topic;                                                               /* Topic of the subscription */
+    amp_msg_t *(*fct)(struct axon_s *, char *, amp_msg_t *, void *);           /* Callback function invoked when topic is received, NULL for a view subscription */
+    amp_msg_t *(*view)(struct axon_s *, char *, struct axon_msg_s *, void *); /* Callback function invoked when topic is received with the "zero copy" option, NULL otherwise */
+    void *      user;                                                          /* User data passed to the callback */
+    char *      literal;                                                       /* Literal searched in the topic, NULL if the topic is not a literal */
+    size_t      size;                                                          /* Size of the literal */
+    int         flags;                                                         /* Trie flags of the literal */
+    regex_t     regex;                                                         /* Compiled regular expression, only if the topic is neither a literal nor a glob pattern */
+    nfa_t *     nfa;                                                           /* Regular expression compiled to a NFA, NULL if its syntax is not supported */
+    wildcard_t *wildcard;                                                      /* Glob pattern, NULL if the topic is not a glob pattern or if it is a literal */
+    atomic_int  refcount;                                                      /* Amount of tables referencing the subscription */
+} axon_sub_t;
+
+/* Subscriptions table, never modified once it has been published */
+typedef struct {
+    atomic_int   refcount;        /* Amount of references, one while the table is the current one plus one per reader */
+    unsigned int generation;      /* Generation of the table, incremented each time subscriptions are updated */
+    size_t       count;           /* Amount of subscriptions */
+    axon_sub_t **subs;            /* Subscriptions, in subscription order */
+    trie_t *     trie;            /* Trie of the literal subscriptions, NULL if there is none */
+    dfa_t *      dfa;             /* Automaton of the regular expression subscriptions compiled to a NFA, NULL if there is none */
+    size_t *     regexes;         /* Indexes of the other regular expression subscriptions */
+    size_t       regexes_count;   /* Amount of other regular expression subscriptions */
+    size_t *     wildcards;       /* Indexes of the glob pattern subscriptions */
+    size_t       wildcards_count; /* Amount of glob pattern subscriptions */
+} subs_table_t;
+
+/* Subscriptions instance */
+typedef struct subs_s {
+    _Atomic(subs_table_t *) table;      /* Current table, replaced by a new one when subscriptions are updated */
+    atomic_int              readers;    /* Amount of readers acquiring the current table */
+    unsigned int            generation; /* Generation of the current table */
+    _Atomic(cache_t *)      cache;      /* Topic match cache, created with the first subscription, NULL if it is disabled */
+    size_t                  cache_size; /* Amount of topics kept in the match cache, 0 to disable it */
+    sem_t                   sem;        /* Semaphore used to serialize the updates */
+} subs_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create subscriptions instance
+ * @return Subscriptions instance if the function succeeded, NULL otherwise
+ */
+subs_t *subs_create(void);
+
+/**
+ * @brief Set the amount of topics kept in the match cache, should be called before subscribing
+ * @param subs Subscriptions instance
+ * @param size Amount of topics, 0 to disable the cache
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int subs_set_cache(subs_t *subs, size_t size);
+
+/**
+ * @brief Add a subscription or update the existing one
+ * @param subs Subscriptions instance
+ * @param topic Topic
+ * @param fct Callback funtion invoked with the decoded messages, NULL if the subscription is a view one
+ * @param view Callback funtion invoked with the messages viewed in the received buffer, NULL if the subscription is a decoded one
+ * @param user User data
+ * @param glob true if the topic is a glob pattern, false if it is a regular expression
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int subs_add(subs_t *subs, char *topic, void *fct, void *view, void *user, bool glob);
+
+/**
+ * @brief Remove a subscription
+ * @param subs Subscriptions instance
+ * @param topic Topic
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int subs_remove(subs_t *subs, char *topic);
+
+/**
+ * @brief Acquire the current subscriptions table, it remains valid until it is released even if subscriptions are updated meanwhile
+ * @param subs Subscriptions instance
+ * @return Subscriptions table
+ */
+subs_table_t *subs_table_acquire(subs_t *subs);
+
+/**
+ * @brief Search the subscriptions matching a topic
+ * @param table Subscriptions table
+ * @param topic Topic, not necessarily null-terminated
+ * @param size Size of the topic
+ * @param matches Array of at least table->count entries filled with the indexes of the matching subscriptions, in subscription order
+ * @return Amount of matching subscriptions
+ */
+size_t subs_table_match(subs_table_t *table, char *topic, size_t size, size_t *matches);
+
+/**
+ * @brief Search the subscriptions matching a topic, using the match cache when the topic has already been received with the same table generation
+ * @param subs Subscriptions instance
+ * @param table Subscriptions table acquired from the subscriptions instance
+ * @param topic Topic, not necessarily null-terminated
+ * @param size Size of the topic
+ * @param matches Array of at least table->count entries filled with the indexes of the matching subscriptions, in subscription order
+ * @return Amount of matching subscriptions
+ */
+size_t subs_match(subs_t *subs, subs_table_t *table, char *topic, size_t size, size_t *matches);
+
+/**
+ * @brief Release a subscriptions table
+ * @param table Subscriptions table
+ */
+void subs_table_release(subs_table_t *table);
+
+/**
+ * @brief Release subscriptions instance
+ * @param subs Subscriptions instance
+ */
+void subs_release(subs_t *subs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SUBS_H__ */
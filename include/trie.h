@@ -0,0 +1,130 @@
+/**
+ * @file      trie.h
+ * @brief     Topic trie used to match literal subscriptions
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __TRIE_H__
+#define __TRIE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Trie pattern flags */
+#define TRIE_ANCHOR_START 0x01 /* Pattern must be found at the beginning of the topic */
+#define TRIE_ANCHOR_END   0x02 /* Pattern must be found at the end of the topic */
+#define TRIE_NOT_START    0x04 /* Pattern must not be found at the beginning of the topic */
+#define TRIE_NOT_END      0x08 /* Pattern must not be found at the end of the topic */
+
+/* Trie node structure */
+typedef struct {
+    int           child;   /* First child node, -1 if there is no child */
+    int           sibling; /* Next sibling node, -1 if there is no sibling */
+    int           fail;    /* Node of the longest proper suffix also present in the trie */
+    int           dict;    /* Node of the longest proper suffix which is the end of a pattern, -1 if there is none */
+    int           output;  /* First pattern ending at this node, -1 if there is none */
+    unsigned char c;       /* Character leading to this node */
+} trie_node_t;
+
+/* Trie output structure */
+typedef struct {
+    size_t index; /* Index given when the pattern has been added */
+    size_t size;  /* Size of the pattern */
+    int    flags; /* Pattern flags */
+    int    next;  /* Next pattern ending at the same node, -1 if there is none */
+} trie_output_t;
+
+/* Trie instance structure, an Aho-Corasick automaton finding all the patterns with a single pass on the topic */
+typedef struct {
+    int            root[256];        /* Children of the root node indexed by character, -1 if there is no child */
+    trie_node_t *  nodes;            /* Nodes, the root node is the first one */
+    size_t         count;            /* Amount of nodes */
+    size_t         capacity;         /* Capacity of the nodes array */
+    trie_output_t *outputs;          /* Patterns */
+    size_t         outputs_count;    /* Amount of patterns */
+    size_t         outputs_capacity; /* Capacity of the patterns array */
+} trie_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a trie instance
+ * @return Trie instance if the function succeeded, NULL otherwise
+ */
+trie_t *trie_create(void);
+
+/**
+ * @brief Add a pattern to the trie, trie_build must be called once all the patterns are added
+ * @param trie Trie instance
+ * @param pattern Pattern
+ * @param size Size of the pattern, must not be 0
+ * @param flags Pattern flags
+ * @param index Index returned when the pattern matches
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int trie_add(trie_t *trie, char *pattern, size_t size, int flags, size_t index);
+
+/**
+ * @brief Build the links of the trie
+ * @param trie Trie instance
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int trie_build(trie_t *trie);
+
+/**
+ * @brief Search all the patterns of the trie in the topic
+ * @param trie Trie instance
+ * @param topic Topic
+ * @param size Size of the topic
+ * @param matches Array to which the indexes of the matching patterns are appended, each index is appended only once
+ * @param count Amount of indexes already present in the array
+ * @return Amount of indexes in the array
+ */
+size_t trie_match(trie_t *trie, char *topic, size_t size, size_t *matches, size_t count);
+
+/**
+ * @brief Release trie instance
+ * @param trie Trie instance
+ */
+void trie_release(trie_t *trie);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TRIE_H__ */
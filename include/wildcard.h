@@ -0,0 +1,92 @@
+/**
+ * @file      wildcard.h
+ * @brief     Glob patterns compatible with Node axon topics
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __WILDCARD_H__
+#define __WILDCARD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Wildcard segment structure */
+typedef struct {
+    char * data; /* Literal characters of the segment */
+    size_t size; /* Size of the segment */
+    size_t gap;  /* Amount of wildcards before the segment, each one matching at least one character */
+} wildcard_segment_t;
+
+/* Wildcard instance structure, a glob pattern split on its wildcards */
+typedef struct {
+    wildcard_segment_t *segments; /* Segments */
+    size_t              count;    /* Amount of segments */
+    size_t              tail;     /* Amount of wildcards after the last segment */
+} wildcard_t;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Function used to compile a glob pattern to a wildcard instance
+ * The pattern matches the whole topic, '*' matches one or more characters and all the other characters are literals as in Node axon.
+ * @param pattern Glob pattern
+ * @return Wildcard instance if the function succeeded, NULL otherwise
+ */
+wildcard_t *wildcard_create(char *pattern);
+
+/**
+ * @brief Check if a topic matches the glob pattern
+ * @param wildcard Wildcard instance
+ * @param topic Topic
+ * @param size Size of the topic
+ * @return true if the topic matches, false otherwise
+ */
+bool wildcard_match(wildcard_t *wildcard, char *topic, size_t size);
+
+/**
+ * @brief Release wildcard instance
+ * @param wildcard Wildcard instance
+ */
+void wildcard_release(wildcard_t *wildcard);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WILDCARD_H__ */
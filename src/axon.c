@@ -37,17 +37,72 @@
 #include <unistd.h>
 #include <assert.h>
 #include <mqueue.h>
-#include <regex.h>
 #include <cJSON.h>
 #include <time.h>
+#include <stdatomic.h>
 
 #include "axon.h"
 #include "sock.h"
+#include "subs.h"
+#include "frame.h"
+#include "builder.h"
+#include "stream.h"
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Size of the topics which are null-terminated without allocating memory when the "zero copy" option is set */
+#define AXON_TOPIC_SIZE 256
+
+/* Received buffer shared by the messages viewing it */
+struct axon_buffer_s {
+    atomic_int refcount; /* Amount of references, one per retained message plus one while the buffer is dispatched */
+    void *     data;     /* Data received */
+};
 
 /******************************************************************************/
 /* Prototypes                                                                 */
 /******************************************************************************/
 
+/**
+ * @brief Create the ID of a new request
+ * @param axon Axon instance
+ * @param str_id Buffer of at least 32 + 1 characters filled with the ID
+ */
+static void axon_message_id(axon_t *axon, char *str_id);
+
+/**
+ * @brief Send an encoded message and wait for the response if Axon instance is Requester
+ * @param axon Axon instance
+ * @param buffer Encoded message, released once it is sent
+ * @param size Size of the encoded message
+ * @param files Parts of files sent within the encoded message, released once they are sent, NULL if there is none
+ * @param count Amount of parts of files
+ * @param str_id ID of the request, NULL if Axon instance is not Requester
+ * @param resp AMP response message, only if Axon instance is Requester
+ * @param timeout Timeout to wait for the response, only if Axon instance is Requester
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int axon_send_frame(axon_t *axon, void *buffer, size_t size, sock_file_t *files, size_t count, char *str_id, amp_msg_t **resp, int timeout);
+
+/**
+ * @brief Close the files of a message which has not been sent
+ * @param files Parts of files, NULL if there is none
+ * @param count Amount of parts of files
+ */
+static void axon_files_close(sock_file_t *files, size_t count);
+
+/**
+ * @brief Push a serialized JSON field to an AMP message, it is pushed as a blob holding the JSON prefix so that it is sent unchanged
+ * @param axon Axon instance
+ * @param amp AMP message
+ * @param json Serialized JSON
+ * @param size Size of the serialized JSON
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int axon_push_json_raw(axon_t *axon, amp_msg_t *amp, char *json, size_t size);
+
 /**
  * @brief Callback function called when socket is bound
  * @param sock Sock instance
@@ -66,6 +121,45 @@ static void axon_bind_cb(sock_t *sock, uint16_t port, void *user);
  */
 static void axon_message_cb(sock_t *sock, void *buffer, size_t size, int socket, void *user);
 
+/**
+ * @brief Handle received data when the "zero copy" option is set, messages are given to the callbacks as views in the buffer
+ * @param axon Axon instance
+ * @param buffer Data received, released once all the messages viewing it are released
+ * @param size Size of data received
+ * @param socket Socket from which the data are received
+ */
+static void axon_message_views(axon_t *axon, void *buffer, size_t size, int socket);
+
+/**
+ * @brief Handle received data when the stream callback is registered, the data are given to the callback as they are received
+ * @param axon Axon instance
+ * @param buffer Data received
+ * @param size Size of data received
+ * @param socket Socket from which the data are received
+ */
+static void axon_message_stream(axon_t *axon, void *buffer, size_t size, int socket);
+
+/**
+ * @brief Release the JSON trees parsed from the fields of a message
+ * @param msg Message
+ */
+static void axon_msg_clear(axon_msg_t *msg);
+
+/**
+ * @brief Release a reference to a received buffer
+ * @param buffer Received buffer
+ */
+static void axon_buffer_release(axon_buffer_t *buffer);
+
+/**
+ * @brief Skip the message at the beginning of the data received if it would be dropped, only the frame header and the topic are read
+ * @param axon Axon instance
+ * @param buffer Data received, moved after the message if it is skipped
+ * @param size Size of data received, decreased if the message is skipped
+ * @return 0 if the message has been skipped, -1 if it should be decoded
+ */
+static int axon_message_skip(axon_t *axon, void **buffer, size_t *size);
+
 /**
  * @brief Callback function called to handle error from sock instance
  * @param sock Sock instance
@@ -74,6 +168,14 @@ static void axon_message_cb(sock_t *sock, void *buffer, size_t size, int socket,
  */
 static void axon_error_cb(sock_t *sock, char *err, void *user);
 
+/**
+ * @brief Callback function called when a client or server socket is closed
+ * @param sock Sock instance
+ * @param socket Socket closed
+ * @param user User data
+ */
+static void axon_close_cb(sock_t *sock, int socket, void *user);
+
 /******************************************************************************/
 /* Functions                                                                  */
 /******************************************************************************/
@@ -122,8 +224,13 @@ axon_create(char *type) {
         return NULL;
     }
 
-    /* Initialize semaphore used to access subscriptions */
-    sem_init(&axon->subs.sem, 0, 1);
+    /* Create subscriptions instance */
+    if (NULL == (axon->subs = subs_create())) {
+        /* Unable to allocate memory */
+        sock_release(axon->sock);
+        free(axon);
+        return NULL;
+    }
 
     /* Register message and error callbacks */
     sock_on(axon->sock, "bind", &axon_bind_cb, axon);
@@ -131,6 +238,7 @@ axon_create(char *type) {
         sock_on(axon->sock, "message", &axon_message_cb, axon);
     }
     sock_on(axon->sock, "error", &axon_error_cb, axon);
+    sock_on(axon->sock, "close", &axon_close_cb, axon);
 
     return axon;
 }
@@ -153,7 +261,7 @@ axon_bind(axon_t *axon, uint16_t port) {
 /**
  * @brief Connect axon to the wanted host and port
  * @param axon Axon instance
- * @param hostname Hostname
+ * @param hostname Hostname, IPv4 or IPv6 address
  * @param port Port
  * @return 0 if the function succeeded, -1 otherwise
  */
@@ -167,6 +275,149 @@ axon_connect(axon_t *axon, char *hostname, uint16_t port) {
     return sock_connect(axon->sock, hostname, port);
 }
 
+/**
+ * @brief Bind axon on the wanted Unix domain socket path
+ * @param axon Axon instance
+ * @param path Path of the socket, shorter than the path of a Unix domain socket address, an existing socket file is removed
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_bind_ipc(axon_t *axon, char *path) {
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != path);
+
+    return sock_bind_ipc(axon->sock, path);
+}
+
+/**
+ * @brief Connect axon to the wanted Unix domain socket path
+ * @param axon Axon instance
+ * @param path Path of the socket, shorter than the path of a Unix domain socket address
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_connect_ipc(axon_t *axon, char *path) {
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != path);
+
+    return sock_connect_ipc(axon->sock, path);
+}
+
+/**
+ * @brief Create a shared memory ring linking axon to a peer of the same host, Publisher and Pusher write to the ring, Subscriber and Puller read from it
+ * @param axon Axon instance
+ * @param name Name of the ring, starting with '/', an existing ring is replaced
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_bind_shm(axon_t *axon, char *name) {
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != name);
+
+    /* Check Axon instance type, rings are one-way */
+    if ((AXON_TYPE_REQ == axon->type) || (AXON_TYPE_REP == axon->type)) {
+        /* Not compatible */
+        return -1;
+    }
+
+    return sock_bind_ring(axon->sock, name, (AXON_TYPE_PUB == axon->type) || (AXON_TYPE_PUSH == axon->type));
+}
+
+/**
+ * @brief Open a shared memory ring created by a peer of the same host, the ring is opened as soon as the peer has created it
+ * @param axon Axon instance
+ * @param name Name of the ring, starting with '/'
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_connect_shm(axon_t *axon, char *name) {
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != name);
+
+    /* Check Axon instance type, rings are one-way */
+    if ((AXON_TYPE_REQ == axon->type) || (AXON_TYPE_REP == axon->type)) {
+        /* Not compatible */
+        return -1;
+    }
+
+    return sock_connect_ring(axon->sock, name, (AXON_TYPE_PUB == axon->type) || (AXON_TYPE_PUSH == axon->type));
+}
+
+/**
+ * @brief Create an in-process queue linking axon to a peer of the same process, Publisher and Pusher write to the queue, Subscriber and Puller read from it
+ * @param axon Axon instance
+ * @param name Name of the queue, unique in the process
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_bind_inproc(axon_t *axon, char *name) {
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != name);
+
+    /* Check Axon instance type, queues are one-way */
+    if ((AXON_TYPE_REQ == axon->type) || (AXON_TYPE_REP == axon->type)) {
+        /* Not compatible */
+        return -1;
+    }
+
+    return sock_bind_inproc(axon->sock, name, (AXON_TYPE_PUB == axon->type) || (AXON_TYPE_PUSH == axon->type));
+}
+
+/**
+ * @brief Open an in-process queue created by a peer of the same process, the queue is opened as soon as the peer has created it
+ * @param axon Axon instance
+ * @param name Name of the queue
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_connect_inproc(axon_t *axon, char *name) {
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != name);
+
+    /* Check Axon instance type, queues are one-way */
+    if ((AXON_TYPE_REQ == axon->type) || (AXON_TYPE_REP == axon->type)) {
+        /* Not compatible */
+        return -1;
+    }
+
+    return sock_connect_inproc(axon->sock, name, (AXON_TYPE_PUB == axon->type) || (AXON_TYPE_PUSH == axon->type));
+}
+
+/**
+ * @brief Bind axon to a UDP multicast group, Publisher sends each message once to the group and Subscriber joins the group to receive them
+ * @param axon Axon instance
+ * @param group IPv4 address of the multicast group
+ * @param port Port of the group
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_bind_multicast(axon_t *axon, char *group, uint16_t port) {
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != group);
+
+    /* Check Axon instance type, only broadcasted messages are sent to the group */
+    if ((AXON_TYPE_PUB != axon->type) && (AXON_TYPE_SUB != axon->type)) {
+        /* Not compatible */
+        return -1;
+    }
+
+    return sock_bind_multicast(axon->sock, group, port, AXON_TYPE_PUB == axon->type);
+}
+
 /**
  * @brief Check if axon is already connected to the wanted host and port
  * @param axon Axon instance
@@ -205,14 +456,69 @@ axon_on(axon_t *axon, char *topic, void *fct, void *user) {
     } else if (!strcmp(topic, "message")) {
         axon->cb.message.fct  = fct;
         axon->cb.message.user = user;
+    } else if (!strcmp(topic, "message view")) {
+        axon->cb.view.fct  = fct;
+        axon->cb.view.user = user;
     } else if (!strcmp(topic, "error")) {
         axon->cb.error.fct  = fct;
         axon->cb.error.user = user;
+    } else if (!strcmp(topic, "stream")) {
+        /* Only Subscriber and Puller messages can be streamed, data received are parsed in reception order by the listenner or reader threads */
+        if ((AXON_TYPE_SUB != axon->type) && (AXON_TYPE_PULL != axon->type)) {
+            /* Not compatible */
+            return -1;
+        }
+        if ((NULL == axon->streams) && (NULL == (axon->streams = (stream_t **)calloc(FD_SETSIZE, sizeof(stream_t *))))) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        axon->cb.stream.fct  = fct;
+        axon->cb.stream.user = user;
+        return axon_set(axon, "inline", 1);
     }
 
     return 0;
 }
 
+/**
+ * @brief Set option, should be called before binding or connecting the instance
+ * @param axon Axon instance
+ * @param name Option name
+ * @param ... Option value
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_set(axon_t *axon, char *name, ...) {
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != name);
+
+    /* Retrieve params */
+    va_list params;
+    va_start(params, name);
+
+    /* Record option, options which are not handled by the Axon instance are handled by the Sock instance */
+    int ret = 0;
+    if (!strcmp(name, "glob")) {
+        axon->options.glob = (0 != va_arg(params, int));
+    } else if (!strcmp(name, "json validate")) {
+        axon->options.json_validate = (0 != va_arg(params, int));
+    } else if (!strcmp(name, "zero copy")) {
+        axon->options.zero_copy = (0 != va_arg(params, int));
+    } else if (!strcmp(name, "topic cache")) {
+        int size = va_arg(params, int);
+        ret      = subs_set_cache(axon->subs, (0 < size) ? (size_t)size : 0);
+    } else {
+        ret = sock_vset(axon->sock, name, params);
+    }
+
+    /* End of params */
+    va_end(params);
+
+    return ret;
+}
+
 /**
  * @brief Subscribe to wanted topic
  * @param axon Axon instance
@@ -233,53 +539,32 @@ axon_subscribe(axon_t *axon, char *topic, void *fct, void *user) {
         return -1;
     }
 
-    int         ret      = 0;
-    axon_sub_t *last_sub = NULL;
+    /* Add or update the subscription, dispatching threads keep using the previous subscriptions until they are done */
+    return subs_add(axon->subs, topic, fct, NULL, user, axon->options.glob);
+}
 
-    /* Wait semaphore */
-    sem_wait(&axon->subs.sem);
+/**
+ * @brief Subscribe to wanted topic, the callback is invoked with the messages viewed in the received buffer when the "zero copy" option is set
+ * @param axon Axon instance
+ * @param topic Topic
+ * @param fct Callback funtion
+ * @param user User data
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_subscribe_view(axon_t *axon, char *topic, void *fct, void *user) {
 
-    /* Parse subscriptions, update callback and user data if topic is found */
-    axon_sub_t *curr_sub = axon->subs.first;
-    while (NULL != curr_sub) {
-        if (!strcmp(topic, curr_sub->topic)) {
-            curr_sub->fct  = fct;
-            curr_sub->user = user;
-            goto LEAVE;
-        }
-        last_sub = curr_sub;
-        curr_sub = curr_sub->next;
-    }
+    assert(NULL != axon);
+    assert(NULL != topic);
 
-    /* Subscription not found, add a new one */
-    axon_sub_t *new_sub = (axon_sub_t *)malloc(sizeof(axon_sub_t));
-    if (NULL == new_sub) {
-        /* Unable to allocate memory */
-        ret = -1;
-        goto LEAVE;
-    }
-    memset(new_sub, 0, sizeof(axon_sub_t));
-    new_sub->topic = strdup(topic);
-    if (NULL == new_sub->topic) {
-        /* Unable to allocate memory */
-        free(new_sub);
-        ret = -1;
-        goto LEAVE;
-    }
-    new_sub->fct  = fct;
-    new_sub->user = user;
-    if (NULL != last_sub) {
-        last_sub->next = new_sub;
-    } else {
-        axon->subs.first = new_sub;
+    /* Check Axon instance type */
+    if ((AXON_TYPE_SUB != axon->type) && (AXON_TYPE_PULL != axon->type)) {
+        /* Not compatible */
+        return -1;
     }
 
-LEAVE:
-
-    /* Release semaphore */
-    sem_post(&axon->subs.sem);
-
-    return ret;
+    /* Add or update the subscription, dispatching threads keep using the previous subscriptions until they are done */
+    return subs_add(axon->subs, topic, NULL, fct, user, axon->options.glob);
 }
 
 /**
@@ -300,34 +585,8 @@ axon_unsubscribe(axon_t *axon, char *topic) {
         return -1;
     }
 
-    axon_sub_t *last_sub = NULL;
-
-    /* Wait semaphore */
-    sem_wait(&axon->subs.sem);
-
-    /* Parse subscriptions, remove subscription if topic is found */
-    axon_sub_t *curr_sub = axon->subs.first;
-    while (NULL != curr_sub) {
-        if (!strcmp(topic, curr_sub->topic)) {
-            if (axon->subs.first == curr_sub) {
-                axon->subs.first = curr_sub->next;
-            } else {
-                last_sub->next = curr_sub->next;
-            }
-            free(curr_sub->topic);
-            free(curr_sub);
-            goto LEAVE;
-        }
-        last_sub = curr_sub;
-        curr_sub = curr_sub->next;
-    }
-
-LEAVE:
-
-    /* Release semaphore */
-    sem_post(&axon->subs.sem);
-
-    return 0;
+    /* Remove the subscription */
+    return subs_remove(axon->subs, topic);
 }
 
 /**
@@ -376,8 +635,6 @@ axon_vsend(axon_t *axon, int count, amp_type_e type1, void *value1, va_list para
     char        str_id[32 + 1];
     amp_msg_t **resp    = NULL;
     int         timeout = 0;
-    char        str_mq[64 + 1];
-    mqd_t       mq;
 
     assert(NULL != axon);
     assert(NULL != axon->sock);
@@ -396,7 +653,8 @@ axon_vsend(axon_t *axon, int count, amp_type_e type1, void *value1, va_list para
     }
 
     /* Push params to AMP message */
-    switch (type1) {
+    int ret = 0;
+    switch ((int)type1) {
         case AMP_TYPE_BLOB:
             blob = value1;
             size = va_arg(params, int);
@@ -414,13 +672,18 @@ axon_vsend(axon_t *axon, int count, amp_type_e type1, void *value1, va_list para
             json = (cJSON *)value1;
             amp_push(amp, type1, json);
             break;
+        case AXON_TYPE_JSON_RAW:
+            str  = (char *)value1;
+            size = va_arg(params, int);
+            ret |= axon_push_json_raw(axon, amp, str, size);
+            break;
         default:
             /* Should not occur */
             break;
     }
     for (int index = 1; index < count; index++) {
         amp_type_e type = va_arg(params, int);
-        switch (type) {
+        switch ((int)type) {
             case AMP_TYPE_BLOB:
                 blob = va_arg(params, void *);
                 size = va_arg(params, int);
@@ -438,11 +701,21 @@ axon_vsend(axon_t *axon, int count, amp_type_e type1, void *value1, va_list para
                 json = va_arg(params, cJSON *);
                 amp_push(amp, type, json);
                 break;
+            case AXON_TYPE_JSON_RAW:
+                str  = va_arg(params, char *);
+                size = va_arg(params, int);
+                ret |= axon_push_json_raw(axon, amp, str, size);
+                break;
             default:
                 /* Should not occur */
                 break;
         }
     }
+    if (0 != ret) {
+        /* Invalid JSON or unable to allocate memory */
+        amp_release(amp);
+        return -1;
+    }
 
     /* If Axon instance is Requester, retrieve AMP response address and timeout */
     if (AXON_TYPE_REQ == axon->type) {
@@ -454,8 +727,7 @@ axon_vsend(axon_t *axon, int count, amp_type_e type1, void *value1, va_list para
     if (AXON_TYPE_REQ == axon->type) {
 
         /* Create the message ID */
-        snprintf(str_id, 32, "%d:%u", getpid(), axon->msg_id);
-        axon->msg_id++;
+        axon_message_id(axon, str_id);
 
         /* Push id at the end of the message */
         amp_push(amp, AMP_TYPE_STRING, str_id, strlen(str_id));
@@ -471,46 +743,180 @@ axon_vsend(axon_t *axon, int count, amp_type_e type1, void *value1, va_list para
     /* Release memory */
     amp_release(amp);
 
-    /* If Axon instance is Requester, create a new message queue to retrieve the response */
+    /* Send AMP encoded buffer and wait for the response if Axon instance is Requester */
+    return axon_send_frame(axon, buffer, size, NULL, 0, (AXON_TYPE_REQ == axon->type) ? str_id : NULL, resp, timeout);
+}
+
+/**
+ * @brief Function used to send the message encoded by a messages builder to the server or to all connected clients, the builder is reset
+ * @param axon Axon instance
+ * @param builder Messages builder
+ * @param ... AMP response message and timeout for Requester instance
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_send_msg(axon_t *axon, axon_msg_builder_t *builder, ...) {
+
+    void *       buffer  = NULL;
+    size_t       size    = 0;
+    sock_file_t *files   = NULL;
+    size_t       count   = 0;
+    char         str_id[32 + 1];
+    amp_msg_t ** resp    = NULL;
+    int          timeout = 0;
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != builder);
+
+    /* Check Axon instance type */
+    if ((AXON_TYPE_PUB != axon->type) && (AXON_TYPE_PUSH != axon->type) && (AXON_TYPE_REQ != axon->type)) {
+        /* Not compatible */
+        axon_msg_builder_reset(builder);
+        return -1;
+    }
+
+    /* If Axon instance is Requester, retrieve AMP response address and timeout and push the id field at the end of the message */
     if (AXON_TYPE_REQ == axon->type) {
-        snprintf(str_mq, 64, "/%s", str_id);
-        struct mq_attr attr = { 0, 1, sizeof(amp_msg_t *), 0 };
-        if (0 > (mq = mq_open(str_mq, O_CREAT | O_RDONLY, 0644, &attr))) {
-            /* Unable to create message queue */
-            free(buffer);
+        va_list params;
+        va_start(params, builder);
+        resp    = va_arg(params, amp_msg_t **);
+        timeout = va_arg(params, int);
+        va_end(params);
+        axon_message_id(axon, str_id);
+        if (0 != builder_add(builder, FRAME_PREFIX_STRING, str_id, strlen(str_id))) {
+            /* Too many fields or unable to allocate memory */
+            axon_msg_builder_reset(builder);
             return -1;
         }
     }
 
-    /* Send AMP encoded buffer */
-    if (0 != sock_send(axon->sock, buffer, size, (AXON_TYPE_PUB == axon->type) ? SOCK_SEND_BROADCAST : SOCK_SEND_ROUND_ROBIN)) {
-        /* Unable to send data */
-        if (AXON_TYPE_REQ == axon->type) {
-            mq_close(mq);
-            mq_unlink(str_mq);
-        }
-        free(buffer);
+    /* Retrieve the encoded message and the files, the builder allocates a new buffer for the next message */
+    if (0 != builder_detach(builder, &buffer, &size, &files, &count)) {
+        /* Empty message or unable to allocate memory */
+        axon_msg_builder_reset(builder);
         return -1;
     }
 
-    /* If Axon instance is Requester, wait for the response */
-    if (AXON_TYPE_REQ == axon->type) {
-        struct timespec tm;
-        clock_gettime(CLOCK_REALTIME, &tm);
-        tm.tv_sec += timeout / 1000;
-        amp_msg_t *tmp = NULL;
-        if (0 > mq_timedreceive(mq, (char *)&tmp, sizeof(amp_msg_t *), NULL, &tm)) {
-            /* Unable to receive data */
-            mq_close(mq);
-            mq_unlink(str_mq);
+    /* Send AMP encoded buffer and wait for the response if Axon instance is Requester */
+    return axon_send_frame(axon, buffer, size, files, count, (AXON_TYPE_REQ == axon->type) ? str_id : NULL, resp, timeout);
+}
+
+/**
+ * @brief Function used to send already encoded messages to the server or to all connected clients, they are sent unchanged after their framing is checked
+ * @param axon Axon instance
+ * @param buffer Encoded messages, one or more complete AMP frames
+ * @param size Size of the encoded messages
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_send_encoded(axon_t *axon, void *buffer, size_t size) {
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert(NULL != buffer);
+
+    /* Check Axon instance type, Requester messages can not be sent unchanged because the ID of the request is added */
+    if ((AXON_TYPE_PUB != axon->type) && (AXON_TYPE_PUSH != axon->type)) {
+        /* Not compatible */
+        return -1;
+    }
+
+    /* Check the buffer is made of complete frames only */
+    if (0 == size) {
+        /* Empty buffer */
+        return -1;
+    }
+    for (size_t offset = 0; offset < size;) {
+        frame_t frame;
+        if (0 != frame_peek((uint8_t *)buffer + offset, size - offset, &frame)) {
+            /* Invalid or incomplete frame */
             return -1;
         }
-        mq_close(mq);
-        mq_unlink(str_mq);
-        *resp = tmp;
+        offset += frame.size;
     }
 
-    return 0;
+    /* Copy the buffer, it is released by the sender once it is sent */
+    void *copy = malloc(size);
+    if (NULL == copy) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    memcpy(copy, buffer, size);
+
+    /* Send AMP encoded buffer */
+    return axon_send_frame(axon, copy, size, NULL, 0, NULL, NULL, 0);
+}
+
+/**
+ * @brief Function used to send a batch of messages to the server or to all connected clients, they are encoded in contiguous buffers sent at once
+ * @param axon Axon instance
+ * @param msgs AMP messages, they are not released
+ * @param count Amount of messages
+ * @return Amount of messages queued, the first ones of the batch, count if the function succeeded, -1 if the instance is not compatible or if memory can't be allocated
+ */
+int
+axon_send_batch(axon_t *axon, amp_msg_t **msgs, size_t count) {
+
+    size_t sent = 0;
+
+    assert(NULL != axon);
+    assert(NULL != axon->sock);
+    assert((NULL != msgs) || (0 == count));
+
+    /* Check Axon instance type, Requester messages are sent one by one to wait for each response */
+    if ((AXON_TYPE_PUB != axon->type) && (AXON_TYPE_PUSH != axon->type)) {
+        /* Not compatible */
+        return -1;
+    }
+    if (0 == count) {
+        return 0;
+    }
+
+    /* Create the messages builder used to encode the chunks */
+    axon_msg_builder_t *builder = axon_msg_builder_create();
+    if (NULL == builder) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    /* Pusher distributes the batch in chunks across the peers, one chunk per peer, Publisher sends a single chunk to all of them */
+    size_t chunks = 1;
+    if (AXON_TYPE_PUSH == axon->type) {
+        int peers = sock_count(axon->sock);
+        chunks    = (1 < peers) ? (((size_t)peers < count) ? (size_t)peers : count) : 1;
+    }
+
+    /* Encode the messages of each chunk one after the other in a contiguous buffer, each chunk is queued once, the messages are queued in order until a chunk fails */
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        size_t last = sent + (count - sent) / (chunks - chunk);
+        for (size_t index = sent; index < last; index++) {
+            if (((sent < index) && (0 != builder_next(builder))) || (0 != builder_encode(builder, msgs[index]))) {
+                /* Unable to encode message */
+                goto LEAVE;
+            }
+        }
+        void *       buffer      = NULL;
+        size_t       size        = 0;
+        sock_file_t *files       = NULL;
+        size_t       files_count = 0;
+        if (0 != builder_detach(builder, &buffer, &size, &files, &files_count)) {
+            /* Unable to encode message */
+            goto LEAVE;
+        }
+        if (0 != axon_send_frame(axon, buffer, size, files, files_count, NULL, NULL, 0)) {
+            /* Unable to send data */
+            goto LEAVE;
+        }
+        sent = last;
+    }
+
+LEAVE:
+
+    /* Release messages builder, the fields already encoded in a chunk which has not been sent are dropped */
+    axon_msg_builder_release(builder);
+
+    return (int)sent;
 }
 
 /**
@@ -545,11 +951,12 @@ axon_reply(axon_t *axon, int count, ...) {
     }
 
     /* Push params to AMP message */
+    int     ret = 0;
     va_list params;
     va_start(params, count);
     for (int index = 0; index < count; index++) {
         amp_type_e type = va_arg(params, int);
-        switch (type) {
+        switch ((int)type) {
             case AMP_TYPE_BLOB:
                 blob = va_arg(params, void *);
                 size = va_arg(params, int);
@@ -567,16 +974,94 @@ axon_reply(axon_t *axon, int count, ...) {
                 json = va_arg(params, cJSON *);
                 amp_push(amp, type, json);
                 break;
+            case AXON_TYPE_JSON_RAW:
+                str  = va_arg(params, char *);
+                size = va_arg(params, int);
+                ret |= axon_push_json_raw(axon, amp, str, size);
+                break;
             default:
                 /* Should not occur */
                 break;
         }
     }
     va_end(params);
+    if (0 != ret) {
+        /* Invalid JSON or unable to allocate memory */
+        amp_release(amp);
+        return NULL;
+    }
 
     return amp;
 }
 
+/**
+ * @brief Retain a message received with the "zero copy" option so that it remains valid after the callback returns
+ * @param msg Message given to the callback
+ * @return Retained message if the function succeeded, NULL otherwise
+ */
+axon_msg_t *
+axon_msg_retain(axon_msg_t *msg) {
+
+    assert(NULL != msg);
+    assert(NULL != msg->buffer);
+
+    /* Copy the message, the views remain valid while the copy holds a reference to the buffer */
+    axon_msg_t *retained = (axon_msg_t *)malloc(sizeof(axon_msg_t));
+    if (NULL == retained) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memcpy(retained, msg, sizeof(axon_msg_t));
+    atomic_fetch_add(&retained->buffer->refcount, 1);
+
+    /* The JSON trees already parsed are moved to the retained message, they are parsed again if the original message is accessed */
+    for (unsigned int index = 0; index < msg->count; index++) {
+        msg->fields[index].json = NULL;
+    }
+
+    return retained;
+}
+
+/**
+ * @brief Retrieve the JSON tree of a field of a message received with the "zero copy" option, the field is parsed on the first call only
+ * @param msg Message
+ * @param index Index of the field
+ * @return JSON tree owned by the message if the function succeeded, NULL if the field is not a valid JSON field
+ */
+cJSON *
+axon_msg_get_json(axon_msg_t *msg, unsigned int index) {
+
+    assert(NULL != msg);
+
+    /* Check the field */
+    if ((index >= msg->count) || (AMP_TYPE_JSON != msg->fields[index].type)) {
+        /* Invalid field */
+        return NULL;
+    }
+
+    /* Parse the field on the first access only */
+    if (NULL == msg->fields[index].json) {
+        msg->fields[index].json = cJSON_ParseWithLength((const char *)msg->fields[index].data, msg->fields[index].size);
+    }
+
+    return msg->fields[index].json;
+}
+
+/**
+ * @brief Release a retained message
+ * @param msg Retained message
+ */
+void
+axon_msg_release(axon_msg_t *msg) {
+
+    /* Release retained message */
+    if (NULL != msg) {
+        axon_msg_clear(msg);
+        axon_buffer_release(msg->buffer);
+        free(msg);
+    }
+}
+
 /**
  * @brief Release axon instance
  * @param axon Axon instance
@@ -591,24 +1076,145 @@ axon_release(axon_t *axon) {
         sock_release(axon->sock);
 
         /* Release subscriptions */
-        sem_wait(&axon->subs.sem);
-        axon_sub_t *curr_sub = axon->subs.first;
-        while (NULL != curr_sub) {
-            axon_sub_t *tmp = curr_sub;
-            curr_sub        = curr_sub->next;
-            if (NULL != tmp->topic) {
-                free(tmp->topic);
+        subs_release(axon->subs);
+
+        /* Release stream parsers */
+        if (NULL != axon->streams) {
+            for (int index = 0; index < FD_SETSIZE; index++) {
+                stream_release(axon->streams[index]);
             }
-            free(tmp);
+            free(axon->streams);
         }
-        sem_post(&axon->subs.sem);
-        sem_close(&axon->subs.sem);
 
         /* Release Axon instance */
         free(axon);
     }
 }
 
+/**
+ * @brief Create the ID of a new request
+ * @param axon Axon instance
+ * @param str_id Buffer of at least 32 + 1 characters filled with the ID
+ */
+static void
+axon_message_id(axon_t *axon, char *str_id) {
+
+    snprintf(str_id, 32, "%d:%u", getpid(), axon->msg_id);
+    axon->msg_id++;
+}
+
+/**
+ * @brief Send an encoded message and wait for the response if Axon instance is Requester
+ * @param axon Axon instance
+ * @param buffer Encoded message, released once it is sent
+ * @param size Size of the encoded message
+ * @param files Parts of files sent within the encoded message, released once they are sent, NULL if there is none
+ * @param count Amount of parts of files
+ * @param str_id ID of the request, NULL if Axon instance is not Requester
+ * @param resp AMP response message, only if Axon instance is Requester
+ * @param timeout Timeout to wait for the response, only if Axon instance is Requester
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+axon_send_frame(axon_t *axon, void *buffer, size_t size, sock_file_t *files, size_t count, char *str_id, amp_msg_t **resp, int timeout) {
+
+    char  str_mq[64 + 1];
+    mqd_t mq;
+
+    /* If Axon instance is Requester, create a new message queue to retrieve the response */
+    if (NULL != str_id) {
+        snprintf(str_mq, 64, "/%s", str_id);
+        struct mq_attr attr = { 0, 1, sizeof(amp_msg_t *), 0 };
+        if (0 > (mq = mq_open(str_mq, O_CREAT | O_RDONLY, 0644, &attr))) {
+            /* Unable to create message queue */
+            axon_files_close(files, count);
+            free(buffer);
+            return -1;
+        }
+    }
+
+    /* Send AMP encoded buffer */
+    if (0 != sock_send_files(axon->sock, buffer, size, files, count, (AXON_TYPE_PUB == axon->type) ? SOCK_SEND_BROADCAST : SOCK_SEND_ROUND_ROBIN)) {
+        /* Unable to send data */
+        if (NULL != str_id) {
+            mq_close(mq);
+            mq_unlink(str_mq);
+        }
+        axon_files_close(files, count);
+        free(buffer);
+        return -1;
+    }
+
+    /* If Axon instance is Requester, wait for the response */
+    if (NULL != str_id) {
+        struct timespec tm;
+        clock_gettime(CLOCK_REALTIME, &tm);
+        tm.tv_sec += timeout / 1000;
+        amp_msg_t *tmp = NULL;
+        if (0 > mq_timedreceive(mq, (char *)&tmp, sizeof(amp_msg_t *), NULL, &tm)) {
+            /* Unable to receive data */
+            mq_close(mq);
+            mq_unlink(str_mq);
+            return -1;
+        }
+        mq_close(mq);
+        mq_unlink(str_mq);
+        *resp = tmp;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Close the files of a message which has not been sent
+ * @param files Parts of files, NULL if there is none
+ * @param count Amount of parts of files
+ */
+static void
+axon_files_close(sock_file_t *files, size_t count) {
+
+    /* Close the file descriptors and release memory */
+    for (size_t index = 0; index < count; index++) {
+        close(files[index].fd);
+    }
+    free(files);
+}
+
+/**
+ * @brief Push a serialized JSON field to an AMP message, it is pushed as a blob holding the JSON prefix so that it is sent unchanged
+ * @param axon Axon instance
+ * @param amp AMP message
+ * @param json Serialized JSON
+ * @param size Size of the serialized JSON
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+axon_push_json_raw(axon_t *axon, amp_msg_t *amp, char *json, size_t size) {
+
+    /* Validate the JSON if wanted */
+    if (true == axon->options.json_validate) {
+        cJSON *tmp = cJSON_ParseWithLength(json, size);
+        if (NULL == tmp) {
+            /* Invalid JSON */
+            return -1;
+        }
+        cJSON_Delete(tmp);
+    }
+
+    /* Blobs have no prefix on the wire, a blob beginning with the JSON prefix is received as a JSON field */
+    uint8_t *data = (uint8_t *)malloc(FRAME_PREFIX_SIZE + size);
+    if (NULL == data) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    memcpy(data, FRAME_PREFIX_JSON, FRAME_PREFIX_SIZE);
+    memcpy(&data[FRAME_PREFIX_SIZE], json, size);
+    int ret = amp_push(amp, AMP_TYPE_BLOB, data, FRAME_PREFIX_SIZE + size);
+    free(data);
+
+    return ret;
+}
+
 /**
  * @brief Callback function called when socket is bound
  * @param sock Sock instance
@@ -648,28 +1254,46 @@ axon_message_cb(sock_t *sock, void *buffer, size_t size, int socket, void *user)
     /* Retrieve axon instance using user data */
     axon_t *axon = (axon_t *)user;
 
+    /* Data are streamed to the callback if wanted */
+    if (NULL != axon->streams) {
+        axon_message_stream(axon, buffer, size, socket);
+        return;
+    }
+
+    /* Messages are viewed in place if wanted, responses of the Requester are always decoded because they are given to the sending thread */
+    if ((true == axon->options.zero_copy) && (AXON_TYPE_REQ != axon->type)) {
+        axon_message_views(axon, buffer, size, socket);
+        return;
+    }
+
     /* Because multiple messages can be received once (but always from the same socket), parse until all the buffer is decoded */
+    void *data = buffer;
     while (0 < size) {
 
+        /* Subscriber or Puller without message callback, skip the messages whose topic matches no subscription without decoding them */
+        if (((AXON_TYPE_SUB == axon->type) || (AXON_TYPE_PULL == axon->type)) && (NULL == axon->cb.message.fct) && (0 == axon_message_skip(axon, &buffer, &size))) {
+            continue;
+        }
+
         /* Create new AMP message */
         amp_msg_t *amp = amp_create();
         if (NULL == amp) {
             /* Unable to allocate memory */
-            return;
+            break;
         }
 
         /* Decode AMP message */
         if (0 != amp_decode(amp, &buffer, &size)) {
             /* Unable to encode message */
             amp_release(amp);
-            return;
+            break;
         }
 
         /* Check the message has at least one field */
         if ((NULL == amp->first) || (NULL == amp->last)) {
             /* Invalid message */
             amp_release(amp);
-            return;
+            break;
         }
 
         /* Treatment depending of Axon instance type */
@@ -757,46 +1381,316 @@ axon_message_cb(sock_t *sock, void *buffer, size_t size, int socket, void *user)
                 axon->cb.message.fct(axon, amp, axon->cb.message.user);
             }
 
-            /* Wait subscriptions semaphore */
-            sem_wait(&axon->subs.sem);
+            /* Acquire subscriptions, callbacks are invoked without lock so they can subscribe or unsubscribe */
+            subs_table_t *table = subs_table_acquire(axon->subs);
 
             /* Invoke susbscriptions callback(s) if defined and if the first field of the AMP message is a string */
-            if ((NULL != axon->subs.first) && (AMP_TYPE_STRING == amp->first->type) && (NULL != amp->first->data)) {
+            if ((0 < table->count) && (AMP_TYPE_STRING == amp->first->type) && (NULL != amp->first->data)) {
 
                 /* Extract topic from the message */
                 amp_field_t *topic_field = amp->first;
                 amp->first               = amp->first->next;
                 amp->count--;
 
-                /* Parse all subscriptions */
-                axon_sub_t *curr_sub = axon->subs.first;
-                while (NULL != curr_sub) {
-                    if (NULL != curr_sub->fct) {
-                        regex_t regex;
-                        if (0 == regcomp(&regex, curr_sub->topic, REG_NOSUB | REG_EXTENDED)) {
-                            if (0 == regexec(&regex, topic_field->data, 0, NULL, 0)) {
-
-                                /* Topic match subscription */
-
-                                /* Invoke subscription callback */
-                                curr_sub->fct(axon, topic_field->data, amp, curr_sub->user);
-                            }
-                            regfree(&regex);
+                /* Search matching subscriptions, the array is allocated only if there are many subscriptions */
+                size_t  stack[SUBS_MATCHES];
+                size_t *matches = (SUBS_MATCHES >= table->count) ? stack : (size_t *)malloc(table->count * sizeof(size_t));
+                if (NULL != matches) {
+                    size_t count = subs_match(axon->subs, table, topic_field->data, strlen(topic_field->data), matches);
+                    for (size_t index = 0; index < count; index++) {
+                        axon_sub_t *curr_sub = table->subs[matches[index]];
+                        if (NULL != curr_sub->fct) {
+
+                            /* Invoke subscription callback */
+                            curr_sub->fct(axon, topic_field->data, amp, curr_sub->user);
                         }
                     }
-                    curr_sub = curr_sub->next;
+                    if (stack != matches) {
+                        free(matches);
+                    }
                 }
                 free(topic_field->data);
                 free(topic_field);
             }
 
-            /* Release subscriptions semaphore */
-            sem_post(&axon->subs.sem);
+            /* Release subscriptions */
+            subs_table_release(table);
 
             /* Release memory */
             amp_release(amp);
         }
     }
+
+    /* Release data received */
+    free(data);
+}
+
+/**
+ * @brief Handle received data when the "zero copy" option is set, messages are given to the callbacks as views in the buffer
+ * @param axon Axon instance
+ * @param buffer Data received, released once all the messages viewing it are released
+ * @param size Size of data received
+ * @param socket Socket from which the data are received
+ */
+static void
+axon_message_views(axon_t *axon, void *buffer, size_t size, int socket) {
+
+    /* Share the buffer between the messages, each retained message takes a reference */
+    axon_buffer_t *shared = (axon_buffer_t *)malloc(sizeof(axon_buffer_t));
+    if (NULL == shared) {
+        /* Unable to allocate memory */
+        free(buffer);
+        return;
+    }
+    atomic_init(&shared->refcount, 1);
+    shared->data = buffer;
+
+    /* Because multiple messages can be received once (but always from the same socket), parse until all the buffer is viewed */
+    uint8_t *curr = (uint8_t *)buffer;
+    while (0 < size) {
+
+        /* Parse the frame, fields are not copied */
+        frame_t frame;
+        if (0 != frame_parse(curr, size, &frame)) {
+            /* Invalid message */
+            break;
+        }
+
+        /* Fill the message */
+        axon_msg_t msg;
+        msg.count      = frame.count;
+        msg.frame      = curr;
+        msg.frame_size = frame.size;
+        msg.buffer     = shared;
+        curr += frame.size;
+        size -= frame.size;
+        for (unsigned int index = 0; index < frame.count; index++) {
+            msg.fields[index].type = frame.fields[index].type;
+            msg.fields[index].data = frame.fields[index].data;
+            msg.fields[index].size = frame.fields[index].size;
+            msg.fields[index].json = NULL;
+        }
+
+        /* Treatment depending of Axon instance type */
+        if (AXON_TYPE_REP == axon->type) {
+
+            /* Axon is Replier, remove the ID field of the request at the end of the message */
+            msg.count--;
+            axon_field_t *id_field = &msg.fields[msg.count];
+            char          str_id[32 + 1];
+            if ((AMP_TYPE_STRING != id_field->type) || (32 < id_field->size)) {
+                /* Invalid message */
+                continue;
+            }
+            memcpy(str_id, id_field->data, id_field->size);
+            str_id[id_field->size] = '\0';
+
+            /* Check if message view callback is define */
+            if (NULL != axon->cb.view.fct) {
+
+                /* Invoke message view callback */
+                amp_msg_t *rep = axon->cb.view.fct(axon, &msg, axon->cb.view.user);
+
+                /* Check if reply is provided */
+                if (NULL != rep) {
+
+                    /* Push the id field of the request at the end of the response */
+                    amp_push(rep, AMP_TYPE_STRING, str_id, strlen(str_id));
+
+                    /* Encode AMP message */
+                    void * buffer_rep = NULL;
+                    size_t size_rep   = 0;
+                    if (0 != amp_encode(rep, &buffer_rep, &size_rep)) {
+                        /* Unable to encode message */
+                    } else {
+                        /* Send AMP encoded buffer */
+                        if (0 != sock_send(axon->sock, buffer_rep, size_rep, socket)) {
+                            /* Unable to send data */
+                        }
+                    }
+
+                    /* Release memory */
+                    amp_release(rep);
+                }
+            }
+
+        } else {
+
+            /* Axon is Subscriber or Puller */
+
+            /* Check if message view callback is define */
+            if (NULL != axon->cb.view.fct) {
+
+                /* Invoke message view callback */
+                axon->cb.view.fct(axon, &msg, axon->cb.view.user);
+            }
+
+            /* Acquire subscriptions, callbacks are invoked without lock so they can subscribe or unsubscribe */
+            subs_table_t *table = subs_table_acquire(axon->subs);
+
+            /* Invoke susbscriptions callback(s) if defined and if the first field of the message is a string */
+            if ((0 < table->count) && (AMP_TYPE_STRING == msg.fields[0].type)) {
+
+                /* Search matching subscriptions in place, the array is allocated only if there are many subscriptions */
+                size_t  stack[SUBS_MATCHES];
+                size_t *matches = (SUBS_MATCHES >= table->count) ? stack : (size_t *)malloc(table->count * sizeof(size_t));
+                if (NULL != matches) {
+                    size_t count = subs_match(axon->subs, table, msg.fields[0].data, msg.fields[0].size, matches);
+                    if (0 < count) {
+
+                        /* The topic given to the callbacks is null-terminated, it is copied in the stack if it is small enough */
+                        char  str_topic[AXON_TOPIC_SIZE];
+                        char *topic = (AXON_TOPIC_SIZE > msg.fields[0].size) ? str_topic : (char *)malloc(msg.fields[0].size + 1);
+                        if (NULL != topic) {
+                            memcpy(topic, msg.fields[0].data, msg.fields[0].size);
+                            topic[msg.fields[0].size] = '\0';
+
+                            /* Extract topic from the message */
+                            msg.count--;
+                            memmove(&msg.fields[0], &msg.fields[1], msg.count * sizeof(axon_field_t));
+
+                            /* Invoke subscriptions view callbacks */
+                            for (size_t index = 0; index < count; index++) {
+                                axon_sub_t *curr_sub = table->subs[matches[index]];
+                                if (NULL != curr_sub->view) {
+                                    curr_sub->view(axon, topic, &msg, curr_sub->user);
+                                }
+                            }
+                            if (str_topic != topic) {
+                                free(topic);
+                            }
+                        }
+                    }
+                    if (stack != matches) {
+                        free(matches);
+                    }
+                }
+            }
+
+            /* Release subscriptions */
+            subs_table_release(table);
+        }
+
+        /* Release the JSON trees parsed by the callbacks, retained messages own the ones parsed before they have been retained */
+        axon_msg_clear(&msg);
+    }
+
+    /* Release the reference of the dispatching thread, the buffer is freed once the retained messages are released */
+    axon_buffer_release(shared);
+}
+
+/**
+ * @brief Handle received data when the stream callback is registered, the data are given to the callback as they are received
+ * @param axon Axon instance
+ * @param buffer Data received
+ * @param size Size of data received
+ * @param socket Socket from which the data are received
+ */
+static void
+axon_message_stream(axon_t *axon, void *buffer, size_t size, int socket) {
+
+    /* Retrieve the stream parser of the socket, it is created with the first data received, data received from rings are made of complete frames */
+    stream_t *stream = (0 <= socket) ? axon->streams[socket] : NULL;
+    if ((NULL == stream) && (NULL == (stream = stream_create()))) {
+        /* Unable to allocate memory */
+        free(buffer);
+        return;
+    }
+    if (0 <= socket) {
+        axon->streams[socket] = stream;
+    }
+
+    /* Parse the data, the current message is aborted if the data are invalid */
+    if (0 != stream_feed(stream, axon, (uint8_t *)buffer, size)) {
+        stream_abort(stream, axon);
+        if (NULL != axon->cb.error.fct) {
+            axon->cb.error.fct(axon, "axon: invalid frame received", axon->cb.error.user);
+        }
+    }
+
+    /* Release data received and the stream parser of rings */
+    free(buffer);
+    if (0 > socket) {
+        stream_release(stream);
+    }
+}
+
+/**
+ * @brief Release the JSON trees parsed from the fields of a message
+ * @param msg Message
+ */
+static void
+axon_msg_clear(axon_msg_t *msg) {
+
+    for (unsigned int index = 0; index < msg->count; index++) {
+        if (NULL != msg->fields[index].json) {
+            cJSON_Delete(msg->fields[index].json);
+            msg->fields[index].json = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Release a reference to a received buffer
+ * @param buffer Received buffer
+ */
+static void
+axon_buffer_release(axon_buffer_t *buffer) {
+
+    /* Release the buffer once the last reference is dropped */
+    if ((NULL != buffer) && (1 == atomic_fetch_sub(&buffer->refcount, 1))) {
+        free(buffer->data);
+        free(buffer);
+    }
+}
+
+/**
+ * @brief Skip the message at the beginning of the data received if it would be dropped, only the frame header and the topic are read
+ * @param axon Axon instance
+ * @param buffer Data received, moved after the message if it is skipped
+ * @param size Size of data received, decreased if the message is skipped
+ * @return 0 if the message has been skipped, -1 if it should be decoded
+ */
+static int
+axon_message_skip(axon_t *axon, void **buffer, size_t *size) {
+
+    frame_t frame;
+    int     ret = -1;
+
+    /* Parse the frame header, incomplete or invalid frames are handled by the decoder */
+    if (0 != frame_peek(*buffer, *size, &frame)) {
+        return -1;
+    }
+
+    /* Acquire subscriptions */
+    subs_table_t *table = subs_table_acquire(axon->subs);
+
+    /* The message is dropped if there is no subscription, if the first field is not a topic or if the topic matches no subscription */
+    if ((0 == table->count) || (AMP_TYPE_STRING != frame.fields[0].type)) {
+        ret = 0;
+    } else {
+        size_t  stack[SUBS_MATCHES];
+        size_t *matches = (SUBS_MATCHES >= table->count) ? stack : (size_t *)malloc(table->count * sizeof(size_t));
+        if (NULL != matches) {
+            if (0 == subs_match(axon->subs, table, (char *)frame.fields[0].data, frame.fields[0].size, matches)) {
+                ret = 0;
+            }
+            if (stack != matches) {
+                free(matches);
+            }
+        }
+    }
+
+    /* Release subscriptions */
+    subs_table_release(table);
+
+    /* Skip the message */
+    if (0 == ret) {
+        *buffer = (uint8_t *)*buffer + frame.size;
+        *size -= frame.size;
+    }
+
+    return ret;
 }
 
 /**
@@ -820,3 +1714,24 @@ axon_error_cb(sock_t *sock, char *err, void *user) {
         axon->cb.error.fct(axon, err, axon->cb.error.user);
     }
 }
+
+/**
+ * @brief Callback function called when a client or server socket is closed
+ * @param sock Sock instance
+ * @param socket Socket closed
+ * @param user User data
+ */
+static void
+axon_close_cb(sock_t *sock, int socket, void *user) {
+
+    (void)sock;
+    assert(NULL != user);
+
+    /* Retrieve axon instance using user data */
+    axon_t *axon = (axon_t *)user;
+
+    /* Abort the message being streamed, the socket may be reused by another connection */
+    if ((NULL != axon->streams) && (NULL != axon->streams[socket])) {
+        stream_abort(axon->streams[socket], axon);
+    }
+}
@@ -0,0 +1,482 @@
+/**
+ * @file      builder.c
+ * @brief     Messages builder encoding fields directly in a reusable buffer
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <cJSON.h>
+
+#include "builder.h"
+#include "frame.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Ensure the encode buffer can hold more data
+ * @param builder Messages builder
+ * @param size Size of the data to be added
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int builder_reserve(axon_msg_builder_t *builder, size_t size);
+
+/**
+ * @brief Write the header of a field
+ * @param curr Position of the header in the encode buffer
+ * @param length Length of the field
+ */
+static void builder_header(uint8_t *curr, size_t length);
+
+/**
+ * @brief Close the files of the message
+ * @param builder Messages builder
+ */
+static void builder_close(axon_msg_builder_t *builder);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a messages builder
+ * @return Messages builder if the function succeeded, NULL otherwise
+ */
+axon_msg_builder_t *
+axon_msg_builder_create(void) {
+
+    /* Create messages builder */
+    axon_msg_builder_t *builder = (axon_msg_builder_t *)malloc(sizeof(axon_msg_builder_t));
+    if (NULL == builder) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(builder, 0, sizeof(axon_msg_builder_t));
+
+    /* The encode buffer is allocated with the first field, the frame header is reserved */
+    builder->capacity = BUILDER_CAPACITY;
+    builder->size     = FRAME_HEADER_SIZE;
+
+    return builder;
+}
+
+/**
+ * @brief Reset the messages builder to encode a new message, the encode buffer is kept and the files are closed
+ * @param builder Messages builder
+ */
+void
+axon_msg_builder_reset(axon_msg_builder_t *builder) {
+
+    assert(NULL != builder);
+
+    builder_close(builder);
+    builder->start = 0;
+    builder->size  = FRAME_HEADER_SIZE;
+    builder->count = 0;
+}
+
+/**
+ * @brief Add a blob field to the message
+ * @param builder Messages builder
+ * @param blob Blob
+ * @param size Size of the blob
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_msg_builder_add_blob(axon_msg_builder_t *builder, void *blob, size_t size) {
+
+    assert(NULL != builder);
+    assert((NULL != blob) || (0 == size));
+
+    return builder_add(builder, NULL, blob, size);
+}
+
+/**
+ * @brief Add a string field to the message
+ * @param builder Messages builder
+ * @param str String
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_msg_builder_add_string(axon_msg_builder_t *builder, char *str) {
+
+    assert(NULL != builder);
+    assert(NULL != str);
+
+    return builder_add(builder, FRAME_PREFIX_STRING, str, strlen(str));
+}
+
+/**
+ * @brief Add a big integer field to the message
+ * @param builder Messages builder
+ * @param value Big integer
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_msg_builder_add_bigint(axon_msg_builder_t *builder, int64_t value) {
+
+    assert(NULL != builder);
+
+    /* Big integers are sent as decimal text */
+    char str[32];
+    int  size = snprintf(str, sizeof(str), "%" PRId64, value);
+
+    return builder_add(builder, FRAME_PREFIX_BIGINT, str, (size_t)size);
+}
+
+/**
+ * @brief Add a JSON field to the message
+ * @param builder Messages builder
+ * @param json JSON tree
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_msg_builder_add_json(axon_msg_builder_t *builder, cJSON *json) {
+
+    assert(NULL != builder);
+    assert(NULL != json);
+
+    /* Print the JSON tree */
+    char *str = cJSON_PrintUnformatted(json);
+    if (NULL == str) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    int ret = builder_add(builder, FRAME_PREFIX_JSON, str, strlen(str));
+    cJSON_free(str);
+
+    return ret;
+}
+
+/**
+ * @brief Add a serialized JSON field to the message, it is written unchanged without being validated
+ * @param builder Messages builder
+ * @param json Serialized JSON
+ * @param size Size of the serialized JSON
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_msg_builder_add_json_raw(axon_msg_builder_t *builder, char *json, size_t size) {
+
+    assert(NULL != builder);
+    assert(NULL != json);
+
+    return builder_add(builder, FRAME_PREFIX_JSON, json, size);
+}
+
+/**
+ * @brief Add a blob field whose data are sent from a file without being read (sendfile), the file is duplicated and can be closed by the caller
+ * @param builder Messages builder
+ * @param fd File descriptor
+ * @param offset Offset of the data in the file
+ * @param size Size of the data
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+axon_msg_builder_add_file(axon_msg_builder_t *builder, int fd, off_t offset, size_t size) {
+
+    assert(NULL != builder);
+    assert(0 <= fd);
+
+    /* Check the amount of fields, the amount of parts of files and the size of the field */
+    if ((FRAME_FIELDS_MAX <= builder->count) || (AXON_FIELDS_MAX <= builder->files_count) || (UINT32_MAX < size)) {
+        /* Too many fields or field too large */
+        return -1;
+    }
+
+    /* Reserve space for the field header, the data are not copied */
+    if (0 != builder_reserve(builder, FRAME_FIELD_HEADER_SIZE)) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    /* Duplicate the file descriptor, it is closed once the message is sent */
+    int tmp = dup(fd);
+    if (0 > tmp) {
+        /* Unable to duplicate the file descriptor */
+        return -1;
+    }
+
+    /* Write the field header and store the part of the file to be sent after it */
+    builder_header(&builder->buffer[builder->size], size);
+    builder->size += FRAME_FIELD_HEADER_SIZE;
+    builder->files[builder->files_count].position = builder->size;
+    builder->files[builder->files_count].fd       = tmp;
+    builder->files[builder->files_count].offset   = offset;
+    builder->files[builder->files_count].size     = size;
+    builder->files_count++;
+    builder->count++;
+
+    return 0;
+}
+
+/**
+ * @brief Release messages builder
+ * @param builder Messages builder
+ */
+void
+axon_msg_builder_release(axon_msg_builder_t *builder) {
+
+    /* Release messages builder */
+    if (NULL != builder) {
+        builder_close(builder);
+        free(builder->buffer);
+        free(builder);
+    }
+}
+
+/**
+ * @brief Add a field to the message
+ * @param builder Messages builder
+ * @param prefix Prefix of the field, NULL for blobs
+ * @param data Data of the field
+ * @param size Size of the data
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+builder_add(axon_msg_builder_t *builder, const char *prefix, const void *data, size_t size) {
+
+    assert(NULL != builder);
+
+    /* Check the amount of fields and the size of the field */
+    size_t length = ((NULL != prefix) ? FRAME_PREFIX_SIZE : 0) + size;
+    if ((FRAME_FIELDS_MAX <= builder->count) || (UINT32_MAX < length)) {
+        /* Too many fields or field too large */
+        return -1;
+    }
+
+    /* Reserve space for the field header and data */
+    if (0 != builder_reserve(builder, FRAME_FIELD_HEADER_SIZE + length)) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    /* Write the field header, the prefix and the data */
+    uint8_t *curr = &builder->buffer[builder->size];
+    builder_header(curr, length);
+    curr += FRAME_FIELD_HEADER_SIZE;
+    if (NULL != prefix) {
+        memcpy(curr, prefix, FRAME_PREFIX_SIZE);
+        curr += FRAME_PREFIX_SIZE;
+    }
+    if (0 < size) {
+        memcpy(curr, data, size);
+    }
+    builder->size += FRAME_FIELD_HEADER_SIZE + length;
+    builder->count++;
+
+    return 0;
+}
+
+/**
+ * @brief Encode an AMP message in the builder, its fields are walked and written to the encode buffer as if they were added one by one
+ * @param builder Messages builder
+ * @param amp AMP message, it is not released
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+builder_encode(axon_msg_builder_t *builder, amp_msg_t *amp) {
+
+    assert(NULL != builder);
+    assert(NULL != amp);
+
+    /* Write each field depending of its type, serialized JSON fields are blobs holding the JSON prefix */
+    for (amp_field_t *field = amp->first; NULL != field; field = field->next) {
+        int ret = -1;
+        switch (field->type) {
+            case AMP_TYPE_BLOB:
+                ret = builder_add(builder, NULL, field->data, field->size);
+                break;
+            case AMP_TYPE_STRING:
+                ret = axon_msg_builder_add_string(builder, (char *)field->data);
+                break;
+            case AMP_TYPE_BIGINT:
+                ret = axon_msg_builder_add_bigint(builder, *(int64_t *)field->data);
+                break;
+            case AMP_TYPE_JSON:
+                ret = axon_msg_builder_add_json(builder, (cJSON *)field->data);
+                break;
+            default:
+                /* Should not occur */
+                break;
+        }
+        if (0 != ret) {
+            /* Unable to write the field */
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Complete the message being encoded and begin the next one after it in the same encode buffer, so that several messages are sent at once
+ * @param builder Messages builder
+ * @return 0 if the function succeeded, -1 if the message has no field or if memory can not be allocated
+ */
+int
+builder_next(axon_msg_builder_t *builder) {
+
+    assert(NULL != builder);
+
+    /* Check the message has at least one field */
+    if (0 == builder->count) {
+        /* Empty message */
+        return -1;
+    }
+
+    /* Reserve space for the frame header of the next message */
+    if (0 != builder_reserve(builder, FRAME_HEADER_SIZE)) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    /* Write the frame header of the message, the next one begins after it */
+    builder->buffer[builder->start] = (uint8_t)((FRAME_VERSION << 4) | builder->count);
+    builder->start                  = builder->size;
+    builder->size += FRAME_HEADER_SIZE;
+    builder->count = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Detach the encoded message from the builder, the builder is reset and allocates a new buffer for the next message
+ * @param builder Messages builder
+ * @param buffer Encoded messages, to be released by the caller
+ * @param size Size of the encoded messages
+ * @param files Parts of files sent within the encoded message, to be released by the caller, NULL if there is none
+ * @param count Amount of parts of files
+ * @return 0 if the function succeeded, -1 if the message has no field or if memory can not be allocated
+ */
+int
+builder_detach(axon_msg_builder_t *builder, void **buffer, size_t *size, sock_file_t **files, size_t *count) {
+
+    assert(NULL != builder);
+    assert(NULL != buffer);
+    assert(NULL != size);
+    assert(NULL != files);
+    assert(NULL != count);
+
+    /* Check the message has at least one field */
+    if (0 == builder->count) {
+        /* Empty message */
+        return -1;
+    }
+
+    /* Give the files to the caller */
+    *files = NULL;
+    *count = builder->files_count;
+    if (0 < builder->files_count) {
+        if (NULL == (*files = (sock_file_t *)malloc(builder->files_count * sizeof(sock_file_t)))) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        memcpy(*files, builder->files, builder->files_count * sizeof(sock_file_t));
+        builder->files_count = 0;
+    }
+
+    /* Write the frame header and give the buffer to the caller */
+    builder->buffer[builder->start] = (uint8_t)((FRAME_VERSION << 4) | builder->count);
+    *buffer                         = builder->buffer;
+    *size                           = builder->size;
+
+    /* Reset the builder, the next buffer is allocated with the same capacity */
+    builder->buffer = NULL;
+    builder->start  = 0;
+    builder->size   = FRAME_HEADER_SIZE;
+    builder->count  = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Ensure the encode buffer can hold more data
+ * @param builder Messages builder
+ * @param size Size of the data to be added
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+builder_reserve(axon_msg_builder_t *builder, size_t size) {
+
+    /* Compute the wanted capacity */
+    size_t capacity = builder->capacity;
+    while (capacity < builder->size + size) {
+        capacity *= 2;
+    }
+
+    /* Allocate or grow the buffer */
+    if ((NULL == builder->buffer) || (capacity > builder->capacity)) {
+        uint8_t *buffer = (uint8_t *)realloc(builder->buffer, capacity);
+        if (NULL == buffer) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        builder->buffer   = buffer;
+        builder->capacity = capacity;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Write the header of a field
+ * @param curr Position of the header in the encode buffer
+ * @param length Length of the field
+ */
+static void
+builder_header(uint8_t *curr, size_t length) {
+
+    /* Length of the field in big endian */
+    curr[0] = (uint8_t)(length >> 24);
+    curr[1] = (uint8_t)(length >> 16);
+    curr[2] = (uint8_t)(length >> 8);
+    curr[3] = (uint8_t)length;
+}
+
+/**
+ * @brief Close the files of the message
+ * @param builder Messages builder
+ */
+static void
+builder_close(axon_msg_builder_t *builder) {
+
+    /* Close the duplicated file descriptors */
+    for (unsigned int index = 0; index < builder->files_count; index++) {
+        close(builder->files[index].fd);
+    }
+    builder->files_count = 0;
+}
@@ -0,0 +1,248 @@
+/**
+ * @file      cache.c
+ * @brief     Topic match cache used to dispatch frequent topics with a single lookup
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <sched.h>
+
+#include "cache.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Compute the hash of a topic (FNV-1a)
+ * @param topic Topic
+ * @param size Size of the topic
+ * @return Hash of the topic
+ */
+static uint64_t cache_hash(char *topic, size_t size);
+
+/**
+ * @brief Lock a slot
+ * @param slot Slot
+ */
+static void cache_slot_lock(cache_slot_t *slot);
+
+/**
+ * @brief Unlock a slot
+ * @param slot Slot
+ */
+static void cache_slot_unlock(cache_slot_t *slot);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a cache instance
+ * @param size Amount of topics, rounded up to a power of 2
+ * @return Cache instance if the function succeeded, NULL otherwise
+ */
+cache_t *
+cache_create(size_t size) {
+
+    assert(0 < size);
+
+    /* Create cache instance */
+    cache_t *cache = (cache_t *)malloc(sizeof(cache_t));
+    if (NULL == cache) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(cache, 0, sizeof(cache_t));
+
+    /* Create slots */
+    size_t count = 1;
+    while (count < size) {
+        count <<= 1;
+    }
+    cache->slots = (cache_slot_t *)malloc(count * sizeof(cache_slot_t));
+    if (NULL == cache->slots) {
+        /* Unable to allocate memory */
+        free(cache);
+        return NULL;
+    }
+    for (size_t index = 0; index < count; index++) {
+        atomic_flag_clear(&cache->slots[index].lock);
+        cache->slots[index].entry = NULL;
+    }
+    cache->mask = count - 1;
+
+    return cache;
+}
+
+/**
+ * @brief Search the matching subscriptions of a topic
+ * @param cache Cache instance
+ * @param generation Generation of the subscriptions table, entries of other generations are ignored
+ * @param topic Topic
+ * @param size Size of the topic
+ * @param matches Array filled with the indexes of the matching subscriptions
+ * @param count Amount of matching subscriptions
+ * @return true if the topic has been found, false otherwise
+ */
+bool
+cache_lookup(cache_t *cache, unsigned int generation, char *topic, size_t size, size_t *matches, size_t *count) {
+
+    assert(NULL != cache);
+    assert(NULL != topic);
+    assert(NULL != matches);
+    assert(NULL != count);
+
+    bool found = false;
+
+    /* Retrieve the slot of the topic */
+    uint64_t      hash = cache_hash(topic, size);
+    cache_slot_t *slot = &cache->slots[hash & cache->mask];
+
+    /* Copy the matches if the slot holds the topic for the wanted generation */
+    cache_slot_lock(slot);
+    cache_entry_t *entry = slot->entry;
+    if ((NULL != entry) && (hash == entry->hash) && (generation == entry->generation) && (size == entry->size) && (0 == memcmp(topic, entry->topic, size))) {
+        memcpy(matches, entry->matches, entry->count * sizeof(size_t));
+        *count = entry->count;
+        found  = true;
+    }
+    cache_slot_unlock(slot);
+
+    return found;
+}
+
+/**
+ * @brief Store the matching subscriptions of a topic, replacing the topic previously stored in the same slot
+ * @param cache Cache instance
+ * @param generation Generation of the subscriptions table
+ * @param topic Topic
+ * @param size Size of the topic
+ * @param matches Indexes of the matching subscriptions
+ * @param count Amount of matching subscriptions
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+cache_insert(cache_t *cache, unsigned int generation, char *topic, size_t size, size_t *matches, size_t count) {
+
+    assert(NULL != cache);
+    assert(NULL != topic);
+    assert((NULL != matches) || (0 == count));
+
+    /* Create the entry, the topic is stored after the matches so that a single allocation is needed */
+    cache_entry_t *entry = (cache_entry_t *)malloc(sizeof(cache_entry_t) + count * sizeof(size_t) + size);
+    if (NULL == entry) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    entry->hash       = cache_hash(topic, size);
+    entry->generation = generation;
+    entry->size       = size;
+    entry->topic      = (char *)&entry->matches[count];
+    entry->count      = count;
+    if (0 < count) {
+        memcpy(entry->matches, matches, count * sizeof(size_t));
+    }
+    memcpy(entry->topic, topic, size);
+
+    /* Replace the entry of the slot */
+    cache_slot_t *slot = &cache->slots[entry->hash & cache->mask];
+    cache_slot_lock(slot);
+    cache_entry_t *prev = slot->entry;
+    slot->entry         = entry;
+    cache_slot_unlock(slot);
+
+    /* Release the previous entry */
+    free(prev);
+
+    return 0;
+}
+
+/**
+ * @brief Release cache instance
+ * @param cache Cache instance
+ */
+void
+cache_release(cache_t *cache) {
+
+    /* Release cache instance */
+    if (NULL != cache) {
+        for (size_t index = 0; index <= cache->mask; index++) {
+            free(cache->slots[index].entry);
+        }
+        free(cache->slots);
+        free(cache);
+    }
+}
+
+/**
+ * @brief Compute the hash of a topic (FNV-1a)
+ * @param topic Topic
+ * @param size Size of the topic
+ * @return Hash of the topic
+ */
+static uint64_t
+cache_hash(char *topic, size_t size) {
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t index = 0; index < size; index++) {
+        hash ^= (unsigned char)topic[index];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Lock a slot
+ * @param slot Slot
+ */
+static void
+cache_slot_lock(cache_slot_t *slot) {
+
+    /* The lock is only held for a copy, yield instead of spinning if it is contended */
+    while (atomic_flag_test_and_set_explicit(&slot->lock, memory_order_acquire)) {
+        sched_yield();
+    }
+}
+
+/**
+ * @brief Unlock a slot
+ * @param slot Slot
+ */
+static void
+cache_slot_unlock(cache_slot_t *slot) {
+
+    atomic_flag_clear_explicit(&slot->lock, memory_order_release);
+}
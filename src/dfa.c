@@ -0,0 +1,592 @@
+/**
+ * @file      dfa.c
+ * @brief     Combined deterministic automaton matching several regular expressions at once
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "dfa.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Compute the closure of NFA states, the result is stored in the set of the DFA instance
+ * @param dfa DFA instance
+ * @param seeds NFA states from which the closure is computed
+ * @param count Amount of NFA states from which the closure is computed
+ * @param bol true if the closure is computed at the beginning of the topic, false otherwise
+ * @param eol true if the closure is computed at the end of the topic, false otherwise
+ * @return Amount of NFA states in the closure
+ */
+static size_t dfa_closure(dfa_t *dfa, int *seeds, size_t count, bool bol, bool eol);
+
+/**
+ * @brief Retrieve the DFA state of the NFA states stored in the set of the DFA instance or create it
+ * @param dfa DFA instance
+ * @param count Amount of NFA states in the set
+ * @param initial true to create the initial state, false otherwise
+ * @return DFA state if the function succeeded, -1 otherwise
+ */
+static int dfa_state_get(dfa_t *dfa, size_t count, bool initial);
+
+/**
+ * @brief Build the transition of a DFA state for a character, the transition is the same for all the characters of its class
+ * @param dfa DFA instance
+ * @param state DFA state
+ * @param c Character
+ * @return Next DFA state if the function succeeded, -1 otherwise
+ */
+static int dfa_state_next(dfa_t *dfa, dfa_state_t *state, unsigned char c);
+
+/**
+ * @brief Append indexes to the array of the matching patterns
+ * @param matches Array to which the indexes are appended, each index is appended only once
+ * @param count Amount of indexes already present in the array
+ * @param indexes Indexes to be appended
+ * @param size Amount of indexes to be appended
+ * @return Amount of indexes in the array
+ */
+static size_t dfa_append(size_t *matches, size_t count, size_t *indexes, size_t size);
+
+/**
+ * @brief Compare two NFA states, used to sort the sets of NFA states
+ * @param a First NFA state
+ * @param b Second NFA state
+ * @return Negative, zero or positive value if the first NFA state is lower, equal or greater than the second one
+ */
+static int dfa_compare(const void *a, const void *b);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a DFA instance
+ * @return DFA instance if the function succeeded, NULL otherwise
+ */
+dfa_t *
+dfa_create(void) {
+
+    /* Create DFA instance */
+    dfa_t *dfa = (dfa_t *)malloc(sizeof(dfa_t));
+    if (NULL == dfa) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(dfa, 0, sizeof(dfa_t));
+
+    /* Initialize semaphore used to serialize the creation of DFA states */
+    sem_init(&dfa->sem, 0, 1);
+
+    return dfa;
+}
+
+/**
+ * @brief Add a pattern to the DFA, dfa_build must be called once all the patterns are added
+ * @param dfa DFA instance
+ * @param nfa Pattern compiled to a NFA instance
+ * @param index Index returned when the pattern matches
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+dfa_add(dfa_t *dfa, nfa_t *nfa, size_t index) {
+
+    assert(NULL != dfa);
+    assert(NULL != nfa);
+
+    /* Grow the NFA states arrays if they are too small */
+    if (dfa->count + nfa->count > dfa->capacity) {
+        size_t capacity = (0 < dfa->capacity) ? dfa->capacity : 64;
+        while (dfa->count + nfa->count > capacity) {
+            capacity *= 2;
+        }
+        nfa_state_t *states = (nfa_state_t *)realloc(dfa->states, capacity * sizeof(nfa_state_t));
+        if (NULL == states) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        dfa->states = states;
+        int *owners = (int *)realloc(dfa->owners, capacity * sizeof(int));
+        if (NULL == owners) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        dfa->owners   = owners;
+        dfa->capacity = capacity;
+    }
+
+    /* Grow the patterns arrays if they are full */
+    if (dfa->patterns_count == dfa->patterns_capacity) {
+        size_t capacity = (0 < dfa->patterns_capacity) ? (2 * dfa->patterns_capacity) : 16;
+        int *  starts   = (int *)realloc(dfa->starts, capacity * sizeof(int));
+        if (NULL == starts) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        dfa->starts     = starts;
+        size_t *indexes = (size_t *)realloc(dfa->indexes, capacity * sizeof(size_t));
+        if (NULL == indexes) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        dfa->indexes           = indexes;
+        dfa->patterns_capacity = capacity;
+    }
+
+    /* Append the NFA states, links are relocated */
+    int offset = (int)dfa->count;
+    for (size_t state = 0; state < nfa->count; state++) {
+        dfa->states[dfa->count]      = nfa->states[state];
+        dfa->states[dfa->count].out  = (0 <= nfa->states[state].out) ? (nfa->states[state].out + offset) : -1;
+        dfa->states[dfa->count].out1 = (0 <= nfa->states[state].out1) ? (nfa->states[state].out1 + offset) : -1;
+        dfa->owners[dfa->count]      = (int)dfa->patterns_count;
+        dfa->count++;
+    }
+    dfa->starts[dfa->patterns_count]  = nfa->start + offset;
+    dfa->indexes[dfa->patterns_count] = index;
+    dfa->patterns_count++;
+
+    return 0;
+}
+
+/**
+ * @brief Build the initial state of the DFA, other states are built when they are first used
+ * @param dfa DFA instance
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+dfa_build(dfa_t *dfa) {
+
+    assert(NULL != dfa);
+
+    /* Split the characters in classes, two characters are in the same class if they are part of the same sets */
+    dfa->classes_count = 1;
+    for (size_t state = 0; state < dfa->count; state++) {
+        if (NFA_TYPE_CHAR == dfa->states[state].type) {
+            int split[512];
+            memset(split, -1, sizeof(split));
+            dfa->classes_count = 0;
+            for (int c = 0; c < 256; c++) {
+                int key = 2 * dfa->classes[c] + (NFA_STATE_HAS(&dfa->states[state], c) ? 1 : 0);
+                if (0 > split[key]) {
+                    split[key] = (int)dfa->classes_count++;
+                }
+                dfa->classes[c] = (uint8_t)split[key];
+            }
+        }
+    }
+
+    /* Allocate memory used to build the DFA states */
+    dfa->cache        = (dfa_state_t **)malloc(DFA_STATES_MAX * sizeof(dfa_state_t *));
+    dfa->hash         = (int *)malloc(2 * DFA_STATES_MAX * sizeof(int));
+    dfa->marks        = (unsigned int *)calloc(dfa->count + 1, sizeof(unsigned int));
+    dfa->owners_marks = (unsigned int *)calloc(dfa->patterns_count + 1, sizeof(unsigned int));
+    dfa->stack        = (int *)malloc((dfa->count + 1) * sizeof(int));
+    dfa->seeds        = (int *)malloc((2 * dfa->count + 1) * sizeof(int));
+    dfa->set          = (int *)malloc((dfa->count + 1) * sizeof(int));
+    dfa->accepts      = (size_t *)malloc((dfa->patterns_count + 1) * sizeof(size_t));
+    if ((NULL == dfa->cache) || (NULL == dfa->hash) || (NULL == dfa->marks) || (NULL == dfa->owners_marks) || (NULL == dfa->stack) || (NULL == dfa->seeds)
+        || (NULL == dfa->set) || (NULL == dfa->accepts)) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    for (size_t index = 0; index < 2 * DFA_STATES_MAX; index++) {
+        dfa->hash[index] = -1;
+    }
+
+    /* Compute the NFA states entered at each character of the topic, patterns matching the empty string are matched by the initial state only */
+    size_t count = dfa_closure(dfa, dfa->starts, dfa->patterns_count, false, false);
+    dfa->mark++;
+    for (size_t index = 0; index < count; index++) {
+        if (NFA_TYPE_MATCH == dfa->states[dfa->set[index]].type) {
+            dfa->owners_marks[dfa->owners[dfa->set[index]]] = dfa->mark;
+        }
+    }
+    dfa->inject = (int *)malloc((count + 1) * sizeof(int));
+    if (NULL == dfa->inject) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    for (size_t index = 0; index < count; index++) {
+        if ((NFA_TYPE_MATCH != dfa->states[dfa->set[index]].type) && (dfa->mark != dfa->owners_marks[dfa->owners[dfa->set[index]]])) {
+            dfa->inject[dfa->inject_count++] = dfa->set[index];
+        }
+    }
+
+    /* Create the initial state */
+    count = dfa_closure(dfa, dfa->starts, dfa->patterns_count, true, false);
+    if (0 > dfa_state_get(dfa, count, true)) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Search all the patterns of the DFA in the topic, the function can be called from several threads at the same time
+ * @param dfa DFA instance
+ * @param topic Topic
+ * @param size Size of the topic
+ * @param matches Array to which the indexes of the matching patterns are appended, each index is appended only once
+ * @param count Amount of indexes in the array, updated if the function succeeded
+ * @return 0 if the function succeeded, -1 if the maximum amount of DFA states is reached
+ */
+int
+dfa_match(dfa_t *dfa, char *topic, size_t size, size_t *matches, size_t *count) {
+
+    assert(NULL != dfa);
+    assert(NULL != topic);
+    assert(NULL != matches);
+    assert(NULL != count);
+
+    /* Start from the initial state */
+    dfa_state_t *state = dfa->cache[0];
+    size_t       found = dfa_append(matches, *count, state->accepts, state->accepts_count);
+
+    /* Single pass on the topic */
+    for (size_t offset = 0; offset < size; offset++) {
+
+        /* Retrieve the next state, building it if it is the first time it is used */
+        unsigned char c    = (unsigned char)topic[offset];
+        int           next = atomic_load_explicit(&state->next[dfa->classes[c]], memory_order_acquire);
+        if (0 > next) {
+            sem_wait(&dfa->sem);
+            next = dfa_state_next(dfa, state, c);
+            sem_post(&dfa->sem);
+            if (0 > next) {
+                /* Maximum amount of DFA states reached */
+                return -1;
+            }
+        }
+        state = dfa->cache[next];
+        found = dfa_append(matches, found, state->accepts, state->accepts_count);
+    }
+
+    /* Patterns matching at the end of the topic */
+    *count = dfa_append(matches, found, state->accepts_end, state->accepts_end_count);
+
+    return 0;
+}
+
+/**
+ * @brief Release DFA instance
+ * @param dfa DFA instance
+ */
+void
+dfa_release(dfa_t *dfa) {
+
+    /* Release DFA instance */
+    if (NULL != dfa) {
+
+        /* Release DFA states */
+        for (size_t index = 0; index < dfa->cache_count; index++) {
+            free(dfa->cache[index]->nfa);
+            free(dfa->cache[index]->accepts);
+            free(dfa->cache[index]->accepts_end);
+            free(dfa->cache[index]);
+        }
+
+        /* Release semaphore */
+        sem_close(&dfa->sem);
+
+        /* Release memory */
+        free(dfa->states);
+        free(dfa->owners);
+        free(dfa->starts);
+        free(dfa->indexes);
+        free(dfa->inject);
+        free(dfa->cache);
+        free(dfa->hash);
+        free(dfa->marks);
+        free(dfa->owners_marks);
+        free(dfa->stack);
+        free(dfa->seeds);
+        free(dfa->set);
+        free(dfa->accepts);
+        free(dfa);
+    }
+}
+
+/**
+ * @brief Compute the closure of NFA states, the result is stored in the set of the DFA instance
+ * @param dfa DFA instance
+ * @param seeds NFA states from which the closure is computed
+ * @param count Amount of NFA states from which the closure is computed
+ * @param bol true if the closure is computed at the beginning of the topic, false otherwise
+ * @param eol true if the closure is computed at the end of the topic, false otherwise
+ * @return Amount of NFA states in the closure
+ */
+static size_t
+dfa_closure(dfa_t *dfa, int *seeds, size_t count, bool bol, bool eol) {
+
+    size_t top = 0, size = 0;
+
+    /* Visit the NFA states reachable without consuming a character, each one only once */
+    dfa->mark++;
+    for (size_t index = 0; index < count; index++) {
+        if (dfa->mark != dfa->marks[seeds[index]]) {
+            dfa->marks[seeds[index]] = dfa->mark;
+            dfa->stack[top++]        = seeds[index];
+        }
+    }
+    while (0 < top) {
+        int          curr  = dfa->stack[--top];
+        nfa_state_t *state = &dfa->states[curr];
+        int          out   = -1;
+        int          out1  = -1;
+        switch (state->type) {
+            case NFA_TYPE_CHAR:
+            case NFA_TYPE_MATCH:
+                dfa->set[size++] = curr;
+                break;
+            case NFA_TYPE_EMPTY:
+                out = state->out;
+                break;
+            case NFA_TYPE_SPLIT:
+                out  = state->out;
+                out1 = state->out1;
+                break;
+            case NFA_TYPE_BOL:
+                /* States following the anchor are never reachable after the beginning of the topic */
+                out = (true == bol) ? state->out : -1;
+                break;
+            case NFA_TYPE_EOL:
+                /* The anchor is kept to be followed when the end of the topic is reached */
+                if (true == eol) {
+                    out = state->out;
+                } else {
+                    dfa->set[size++] = curr;
+                }
+                break;
+        }
+        if ((0 <= out) && (dfa->mark != dfa->marks[out])) {
+            dfa->marks[out]   = dfa->mark;
+            dfa->stack[top++] = out;
+        }
+        if ((0 <= out1) && (dfa->mark != dfa->marks[out1])) {
+            dfa->marks[out1]  = dfa->mark;
+            dfa->stack[top++] = out1;
+        }
+    }
+
+    return size;
+}
+
+/**
+ * @brief Retrieve the DFA state of the NFA states stored in the set of the DFA instance or create it
+ * @param dfa DFA instance
+ * @param count Amount of NFA states in the set
+ * @param initial true to create the initial state, false otherwise
+ * @return DFA state if the function succeeded, -1 otherwise
+ */
+static int
+dfa_state_get(dfa_t *dfa, size_t count, bool initial) {
+
+    /* Retrieve the patterns matching, the set is sorted first so that they are always retrieved in the same order */
+    qsort(dfa->set, count, sizeof(int), dfa_compare);
+    size_t accepts_count = 0;
+    dfa->mark++;
+    for (size_t index = 0; index < count; index++) {
+        int owner = dfa->owners[dfa->set[index]];
+        if ((NFA_TYPE_MATCH == dfa->states[dfa->set[index]].type) && (dfa->mark != dfa->owners_marks[owner])) {
+            dfa->owners_marks[owner]      = dfa->mark;
+            dfa->accepts[accepts_count++] = dfa->indexes[owner];
+        }
+    }
+
+    /* Remove the NFA states of the patterns matching, they are already found */
+    size_t size = 0;
+    for (size_t index = 0; index < count; index++) {
+        if (dfa->mark != dfa->owners_marks[dfa->owners[dfa->set[index]]]) {
+            dfa->set[size++] = dfa->set[index];
+        }
+    }
+
+    /* Search the state in the hash table, the initial state is never searched because its transitions are not the same */
+    uint32_t hash = 2166136261u;
+    for (size_t index = 0; index < size; index++) {
+        hash = (hash ^ (uint32_t)dfa->set[index]) * 16777619u;
+    }
+    for (size_t index = 0; index < accepts_count; index++) {
+        hash = (hash ^ (uint32_t)dfa->accepts[index]) * 16777619u;
+    }
+    size_t slot = hash % (2 * DFA_STATES_MAX);
+    if (false == initial) {
+        while (0 <= dfa->hash[slot]) {
+            dfa_state_t *state = dfa->cache[dfa->hash[slot]];
+            if ((state->count == size) && (state->accepts_count == accepts_count) && (0 == memcmp(state->nfa, dfa->set, size * sizeof(int)))
+                && (0 == memcmp(state->accepts, dfa->accepts, accepts_count * sizeof(size_t)))) {
+                return dfa->hash[slot];
+            }
+            slot = (slot + 1) % (2 * DFA_STATES_MAX);
+        }
+    }
+    if (DFA_STATES_MAX == dfa->cache_count) {
+        /* Maximum amount of DFA states reached */
+        return -1;
+    }
+
+    /* Create the state */
+    dfa_state_t *state = (dfa_state_t *)malloc(sizeof(dfa_state_t) + dfa->classes_count * sizeof(atomic_int));
+    if (NULL == state) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    memset(state, 0, sizeof(dfa_state_t));
+    state->nfa     = (int *)malloc((size + 1) * sizeof(int));
+    state->accepts = (size_t *)malloc((accepts_count + 1) * sizeof(size_t));
+    if ((NULL == state->nfa) || (NULL == state->accepts)) {
+        /* Unable to allocate memory */
+        free(state->nfa);
+        free(state->accepts);
+        free(state);
+        return -1;
+    }
+    memcpy(state->nfa, dfa->set, size * sizeof(int));
+    state->count = size;
+    memcpy(state->accepts, dfa->accepts, accepts_count * sizeof(size_t));
+    state->accepts_count = accepts_count;
+    for (size_t index = 0; index < dfa->classes_count; index++) {
+        atomic_init(&state->next[index], -1);
+    }
+
+    /* Retrieve the patterns matching if the topic ends in this state */
+    count         = dfa_closure(dfa, state->nfa, state->count, initial, true);
+    accepts_count = 0;
+    dfa->mark++;
+    for (size_t index = 0; index < count; index++) {
+        int owner = dfa->owners[dfa->set[index]];
+        if ((NFA_TYPE_MATCH == dfa->states[dfa->set[index]].type) && (dfa->mark != dfa->owners_marks[owner])) {
+            dfa->owners_marks[owner]      = dfa->mark;
+            dfa->accepts[accepts_count++] = dfa->indexes[owner];
+        }
+    }
+    state->accepts_end = (size_t *)malloc((accepts_count + 1) * sizeof(size_t));
+    if (NULL == state->accepts_end) {
+        /* Unable to allocate memory */
+        free(state->nfa);
+        free(state->accepts);
+        free(state);
+        return -1;
+    }
+    memcpy(state->accepts_end, dfa->accepts, accepts_count * sizeof(size_t));
+    state->accepts_end_count = accepts_count;
+
+    /* Add the state to the cache */
+    if (false == initial) {
+        dfa->hash[slot] = (int)dfa->cache_count;
+    }
+    dfa->cache[dfa->cache_count] = state;
+
+    return (int)dfa->cache_count++;
+}
+
+/**
+ * @brief Build the transition of a DFA state for a character, the transition is the same for all the characters of its class
+ * @param dfa DFA instance
+ * @param state DFA state
+ * @param c Character
+ * @return Next DFA state if the function succeeded, -1 otherwise
+ */
+static int
+dfa_state_next(dfa_t *dfa, dfa_state_t *state, unsigned char c) {
+
+    /* Check if the transition has been built meanwhile */
+    int next = atomic_load_explicit(&state->next[dfa->classes[c]], memory_order_acquire);
+    if (0 <= next) {
+        return next;
+    }
+
+    /* Consume the character, then enter again the patterns so that they are searched anywhere in the topic */
+    size_t count = 0;
+    for (size_t index = 0; index < state->count; index++) {
+        nfa_state_t *curr = &dfa->states[state->nfa[index]];
+        if ((NFA_TYPE_CHAR == curr->type) && (NFA_STATE_HAS(curr, c))) {
+            dfa->seeds[count++] = curr->out;
+        }
+    }
+    memcpy(&dfa->seeds[count], dfa->inject, dfa->inject_count * sizeof(int));
+    count += dfa->inject_count;
+
+    /* Retrieve the next state or create it */
+    count = dfa_closure(dfa, dfa->seeds, count, false, false);
+    if (0 > (next = dfa_state_get(dfa, count, false))) {
+        return -1;
+    }
+    atomic_store_explicit(&state->next[dfa->classes[c]], next, memory_order_release);
+
+    return next;
+}
+
+/**
+ * @brief Append indexes to the array of the matching patterns
+ * @param matches Array to which the indexes are appended, each index is appended only once
+ * @param count Amount of indexes already present in the array
+ * @param indexes Indexes to be appended
+ * @param size Amount of indexes to be appended
+ * @return Amount of indexes in the array
+ */
+static size_t
+dfa_append(size_t *matches, size_t count, size_t *indexes, size_t size) {
+
+    for (size_t index = 0; index < size; index++) {
+        size_t curr = 0;
+        while ((curr < count) && (matches[curr] != indexes[index])) {
+            curr++;
+        }
+        if (curr == count) {
+            matches[count++] = indexes[index];
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Compare two NFA states, used to sort the sets of NFA states
+ * @param a First NFA state
+ * @param b Second NFA state
+ * @return Negative, zero or positive value if the first NFA state is lower, equal or greater than the second one
+ */
+static int
+dfa_compare(const void *a, const void *b) {
+
+    int state_a = *(const int *)a;
+    int state_b = *(const int *)b;
+
+    return (state_a > state_b) - (state_a < state_b);
+}
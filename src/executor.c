@@ -0,0 +1,493 @@
+/**
+ * @file      executor.c
+ * @brief     Work-stealing executor used to dispatch messages
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <pthread.h>
+
+#include "executor.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Executor thread used to run tasks
+ * @param arg Worker
+ * @return Always returns NULL
+ */
+static void *executor_thread_worker(void *arg);
+
+/**
+ * @brief Task used to run the tasks queued in a strand
+ * @param arg Strand
+ */
+static void executor_task_strand(void *arg);
+
+/**
+ * @brief Push a task at the end of the deque of a worker
+ * @param worker Worker
+ * @param task Task to push
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int executor_push(executor_worker_t *worker, executor_task_t *task);
+
+/**
+ * @brief Pop the oldest task of the deque of a worker
+ * @param worker Worker
+ * @param task Task popped
+ * @return 0 if the function succeeded, -1 if the deque is empty
+ */
+static int executor_pop(executor_worker_t *worker, executor_task_t *task);
+
+/**
+ * @brief Steal the newest task of the deque of a worker
+ * @param worker Worker
+ * @param task Task stolen
+ * @return 0 if the function succeeded, -1 if the deque is empty
+ */
+static int executor_steal(executor_worker_t *worker, executor_task_t *task);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create an executor instance
+ * @param count Amount of workers
+ * @return Executor instance if the function succeeded, NULL otherwise
+ */
+executor_t *
+executor_create(int count) {
+
+    assert(0 < count);
+
+    /* Create executor instance */
+    executor_t *executor = (executor_t *)malloc(sizeof(executor_t));
+    if (NULL == executor) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(executor, 0, sizeof(executor_t));
+    atomic_init(&executor->next, 0);
+    atomic_init(&executor->stop, false);
+
+    /* Create workers and strands */
+    executor->workers = (executor_worker_t *)malloc(count * sizeof(executor_worker_t));
+    if (NULL == executor->workers) {
+        /* Unable to allocate memory */
+        free(executor);
+        return NULL;
+    }
+    memset(executor->workers, 0, count * sizeof(executor_worker_t));
+    executor->strands = (executor_strand_t *)malloc(EXECUTOR_STRANDS * sizeof(executor_strand_t));
+    if (NULL == executor->strands) {
+        /* Unable to allocate memory */
+        free(executor->workers);
+        free(executor);
+        return NULL;
+    }
+    memset(executor->strands, 0, EXECUTOR_STRANDS * sizeof(executor_strand_t));
+
+    /* Initialize semaphores */
+    sem_init(&executor->pending, 0, 0);
+    for (int index = 0; index < EXECUTOR_STRANDS; index++) {
+        sem_init(&executor->strands[index].sem, 0, 1);
+    }
+    for (int index = 0; index < count; index++) {
+        executor->workers[index].parent = executor;
+        executor->workers[index].cpu    = -1;
+        sem_init(&executor->workers[index].deque.sem, 0, 1);
+    }
+
+    /* Start workers */
+    for (int index = 0; index < count; index++) {
+        if (0 != pthread_create(&executor->workers[index].thread, NULL, executor_thread_worker, (void *)&executor->workers[index])) {
+            /* Unable to start the thread */
+            break;
+        }
+        executor->count++;
+    }
+    if (0 == executor->count) {
+        /* Unable to start any worker */
+        executor_release(executor);
+        return NULL;
+    }
+
+    return executor;
+}
+
+/**
+ * @brief Pin each worker on one of the wanted CPUs
+ * @param executor Executor instance
+ * @param cpus CPUs on which the workers are distributed, empty set to unpin the workers
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+executor_set_affinity(executor_t *executor, cpu_set_t *cpus) {
+
+    assert(NULL != executor);
+    assert(NULL != cpus);
+
+    int ret = 0;
+
+    /* Unpin the workers if the set is empty */
+    if (0 == CPU_COUNT(cpus)) {
+        cpu_set_t all;
+        CPU_ZERO(&all);
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, &all);
+        }
+        for (int index = 0; index < executor->count; index++) {
+            executor->workers[index].cpu = -1;
+            if (0 != pthread_setaffinity_np(executor->workers[index].thread, sizeof(cpu_set_t), &all)) {
+                ret = -1;
+            }
+        }
+        return ret;
+    }
+
+    /* Distribute the workers on the CPUs of the set, one CPU per worker */
+    int cpu = -1;
+    for (int index = 0; index < executor->count; index++) {
+        do {
+            cpu = (cpu + 1) % CPU_SETSIZE;
+        } while (!CPU_ISSET(cpu, cpus));
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (0 != pthread_setaffinity_np(executor->workers[index].thread, sizeof(cpu_set_t), &set)) {
+            /* Unable to pin the worker */
+            executor->workers[index].cpu = -1;
+            ret                          = -1;
+        } else {
+            executor->workers[index].cpu = cpu;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Submit a task to the executor
+ * @param executor Executor instance
+ * @param key Tasks submitted with the same non-negative key are run one after the other in submission order, -1 if the task can be run at any time
+ * @param cpu Preferred CPU, the task is queued to the worker pinned on this CPU if any, -1 if there is no preference
+ * @param fct Function invoked to run the task
+ * @param arg Argument passed to the function
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+executor_submit(executor_t *executor, int key, int cpu, void (*fct)(void *), void *arg) {
+
+    assert(NULL != executor);
+    assert(NULL != fct);
+
+    executor_task_t task = { fct, arg };
+
+    /* Queue the task in its strand if ordering is requested */
+    if (0 <= key) {
+
+        /* Create new node */
+        executor_node_t *node = (executor_node_t *)malloc(sizeof(executor_node_t));
+        if (NULL == node) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        node->next = NULL;
+        node->task = task;
+
+        /* Add node to the strand, the strand is scheduled only if it is not already queued or running */
+        executor_strand_t *strand = &executor->strands[key % EXECUTOR_STRANDS];
+        sem_wait(&strand->sem);
+        if (NULL == strand->last) {
+            strand->first = strand->last = node;
+        } else {
+            strand->last->next = node;
+            strand->last       = node;
+        }
+        if (true == strand->scheduled) {
+            sem_post(&strand->sem);
+            return 0;
+        }
+        strand->scheduled = true;
+        sem_post(&strand->sem);
+
+        /* Schedule the strand */
+        task.fct = executor_task_strand;
+        task.arg = strand;
+    }
+
+    /* Push the task to the worker pinned on the preferred CPU or to the next worker, idle workers will steal it if this one is busy */
+    executor_worker_t *worker = NULL;
+    for (int index = 0; (0 <= cpu) && (index < executor->count) && (NULL == worker); index++) {
+        if (cpu == executor->workers[index].cpu) {
+            worker = &executor->workers[index];
+        }
+    }
+    if (NULL == worker) {
+        worker = &executor->workers[atomic_fetch_add(&executor->next, 1) % executor->count];
+    }
+    if (0 != executor_push(worker, &task)) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    /* Wake up a worker */
+    sem_post(&executor->pending);
+
+    return 0;
+}
+
+/**
+ * @brief Release executor instance, pending tasks are run before the workers are stopped
+ * @param executor Executor instance
+ */
+void
+executor_release(executor_t *executor) {
+
+    /* Release executor instance */
+    if (NULL != executor) {
+
+        /* Stop workers once all the pending tasks have been run */
+        atomic_store(&executor->stop, true);
+        for (int index = 0; index < executor->count; index++) {
+            sem_post(&executor->pending);
+        }
+        for (int index = 0; index < executor->count; index++) {
+            pthread_join(executor->workers[index].thread, NULL);
+        }
+
+        /* Release workers */
+        for (int index = 0; index < executor->count; index++) {
+            free(executor->workers[index].deque.tasks);
+            sem_close(&executor->workers[index].deque.sem);
+        }
+        free(executor->workers);
+
+        /* Release strands */
+        for (int index = 0; index < EXECUTOR_STRANDS; index++) {
+            sem_close(&executor->strands[index].sem);
+        }
+        free(executor->strands);
+
+        /* Release executor instance */
+        sem_close(&executor->pending);
+        free(executor);
+    }
+}
+
+/**
+ * @brief Executor thread used to run tasks
+ * @param arg Worker
+ * @return Always returns NULL
+ */
+static void *
+executor_thread_worker(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Retrieve worker */
+    executor_worker_t *worker   = (executor_worker_t *)arg;
+    executor_t *       executor = worker->parent;
+    int                self     = (int)(worker - executor->workers);
+
+    /* Set thread name */
+    char name[16];
+    snprintf(name, sizeof(name), "axon-worker/%d", self);
+    pthread_setname_np(pthread_self(), name);
+
+    /* Infinite loop */
+    while (1) {
+
+        /* Wait until a task is available */
+        sem_wait(&executor->pending);
+
+        /* Pop the oldest task of my own deque, steal the newest task of the other workers otherwise */
+        executor_task_t task;
+        bool            found = (0 == executor_pop(worker, &task));
+        while (false == found) {
+            for (int index = 1; (index < executor->count) && (false == found); index++) {
+                found = (0 == executor_steal(&executor->workers[(self + index) % executor->count], &task));
+            }
+            if (false == found) {
+                if (true == atomic_load(&executor->stop)) {
+                    /* No more task, stop the worker */
+                    return NULL;
+                }
+                /* The task has been taken by another worker which is going to consume its own wake up, search again */
+                sched_yield();
+                found = (0 == executor_pop(worker, &task));
+            }
+        }
+
+        /* Run the task */
+        task.fct(task.arg);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Task used to run the tasks queued in a strand
+ * @param arg Strand
+ */
+static void
+executor_task_strand(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Retrieve strand */
+    executor_strand_t *strand = (executor_strand_t *)arg;
+
+    /* Run the tasks of the strand in submission order until it is empty */
+    while (1) {
+        sem_wait(&strand->sem);
+        executor_node_t *node = strand->first;
+        if (NULL == node) {
+            strand->scheduled = false;
+            sem_post(&strand->sem);
+            return;
+        }
+        strand->first = node->next;
+        if (NULL == strand->first) {
+            strand->last = NULL;
+        }
+        sem_post(&strand->sem);
+        node->task.fct(node->task.arg);
+        free(node);
+    }
+}
+
+/**
+ * @brief Push a task at the end of the deque of a worker
+ * @param worker Worker
+ * @param task Task to push
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+executor_push(executor_worker_t *worker, executor_task_t *task) {
+
+    int ret = 0;
+
+    /* Wait semaphore */
+    sem_wait(&worker->deque.sem);
+
+    /* Grow the circular buffer if it is full */
+    if (worker->deque.count == worker->deque.capacity) {
+        size_t           capacity = (0 < worker->deque.capacity) ? (2 * worker->deque.capacity) : 64;
+        executor_task_t *tasks    = (executor_task_t *)malloc(capacity * sizeof(executor_task_t));
+        if (NULL == tasks) {
+            /* Unable to allocate memory */
+            ret = -1;
+            goto LEAVE;
+        }
+        for (size_t index = 0; index < worker->deque.count; index++) {
+            tasks[index] = worker->deque.tasks[(worker->deque.head + index) % worker->deque.capacity];
+        }
+        free(worker->deque.tasks);
+        worker->deque.tasks    = tasks;
+        worker->deque.head     = 0;
+        worker->deque.capacity = capacity;
+    }
+
+    /* Add the task */
+    worker->deque.tasks[(worker->deque.head + worker->deque.count) % worker->deque.capacity] = *task;
+    worker->deque.count++;
+
+LEAVE:
+
+    /* Release semaphore */
+    sem_post(&worker->deque.sem);
+
+    return ret;
+}
+
+/**
+ * @brief Pop the oldest task of the deque of a worker
+ * @param worker Worker
+ * @param task Task popped
+ * @return 0 if the function succeeded, -1 if the deque is empty
+ */
+static int
+executor_pop(executor_worker_t *worker, executor_task_t *task) {
+
+    int ret = -1;
+
+    /* Wait semaphore */
+    sem_wait(&worker->deque.sem);
+
+    /* Remove the oldest task */
+    if (0 < worker->deque.count) {
+        *task              = worker->deque.tasks[worker->deque.head];
+        worker->deque.head = (worker->deque.head + 1) % worker->deque.capacity;
+        worker->deque.count--;
+        ret = 0;
+    }
+
+    /* Release semaphore */
+    sem_post(&worker->deque.sem);
+
+    return ret;
+}
+
+/**
+ * @brief Steal the newest task of the deque of a worker
+ * @param worker Worker
+ * @param task Task stolen
+ * @return 0 if the function succeeded, -1 if the deque is empty
+ */
+static int
+executor_steal(executor_worker_t *worker, executor_task_t *task) {
+
+    int ret = -1;
+
+    /* Wait semaphore */
+    sem_wait(&worker->deque.sem);
+
+    /* Remove the newest task */
+    if (0 < worker->deque.count) {
+        worker->deque.count--;
+        *task = worker->deque.tasks[(worker->deque.head + worker->deque.count) % worker->deque.capacity];
+        ret   = 0;
+    }
+
+    /* Release semaphore */
+    sem_post(&worker->deque.sem);
+
+    return ret;
+}
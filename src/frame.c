@@ -0,0 +1,163 @@
+/**
+ * @file      frame.c
+ * @brief     AMP frames parsing without decoding
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "frame.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Parse the frame at the beginning of a buffer
+ * @param buffer Buffer
+ * @param size Size of the buffer
+ * @param frame Frame filled with the size of the frame and the views of its fields
+ * @param count Amount of fields views to fill
+ * @return 0 if the buffer begins with a complete frame, -1 otherwise
+ */
+static int frame_read(void *buffer, size_t size, frame_t *frame, unsigned int count);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Parse the header of the frame at the beginning of a buffer, only the fields headers are read
+ * @param buffer Buffer
+ * @param size Size of the buffer
+ * @param frame Frame filled with the size of the frame and a view of its first field
+ * @return 0 if the buffer begins with a complete frame, -1 otherwise
+ */
+int
+frame_peek(void *buffer, size_t size, frame_t *frame) {
+
+    assert(NULL != buffer);
+    assert(NULL != frame);
+
+    return frame_read(buffer, size, frame, 1);
+}
+
+/**
+ * @brief Parse the frame at the beginning of a buffer, all the fields are viewed in place without copy
+ * @param buffer Buffer
+ * @param size Size of the buffer
+ * @param frame Frame filled with the size of the frame and the views of all its fields
+ * @return 0 if the buffer begins with a complete frame, -1 otherwise
+ */
+int
+frame_parse(void *buffer, size_t size, frame_t *frame) {
+
+    assert(NULL != buffer);
+    assert(NULL != frame);
+
+    return frame_read(buffer, size, frame, FRAME_FIELDS_MAX);
+}
+
+/**
+ * @brief Retrieve the type of a field using its prefix
+ * @param data Data of the field, including the prefix
+ * @param size Size of the data
+ * @param field Field view filled with the type and the data without prefix
+ */
+void
+frame_field(uint8_t *data, size_t size, frame_field_t *field) {
+
+    assert((NULL != data) || (0 == size));
+    assert(NULL != field);
+
+    /* Blobs have no prefix */
+    field->type = AMP_TYPE_BLOB;
+    field->data = data;
+    field->size = size;
+    if (FRAME_PREFIX_SIZE <= size) {
+        if (!memcmp(data, FRAME_PREFIX_STRING, FRAME_PREFIX_SIZE)) {
+            field->type = AMP_TYPE_STRING;
+        } else if (!memcmp(data, FRAME_PREFIX_BIGINT, FRAME_PREFIX_SIZE)) {
+            field->type = AMP_TYPE_BIGINT;
+        } else if (!memcmp(data, FRAME_PREFIX_JSON, FRAME_PREFIX_SIZE)) {
+            field->type = AMP_TYPE_JSON;
+        }
+    }
+    if (AMP_TYPE_BLOB != field->type) {
+        field->data += FRAME_PREFIX_SIZE;
+        field->size -= FRAME_PREFIX_SIZE;
+    }
+}
+
+/**
+ * @brief Parse the frame at the beginning of a buffer
+ * @param buffer Buffer
+ * @param size Size of the buffer
+ * @param frame Frame filled with the size of the frame and the views of its fields
+ * @param count Amount of fields views to fill
+ * @return 0 if the buffer begins with a complete frame, -1 otherwise
+ */
+static int
+frame_read(void *buffer, size_t size, frame_t *frame, unsigned int count) {
+
+    uint8_t *data = (uint8_t *)buffer;
+
+    /* Check the header */
+    if ((FRAME_HEADER_SIZE > size) || (FRAME_VERSION != (data[0] >> 4)) || (0 == (data[0] & 0x0F))) {
+        /* Invalid or incomplete frame */
+        return -1;
+    }
+    frame->count = data[0] & 0x0F;
+
+    /* Walk the fields headers to compute the size of the frame */
+    size_t offset = FRAME_HEADER_SIZE;
+    for (unsigned int index = 0; index < frame->count; index++) {
+        if (FRAME_FIELD_HEADER_SIZE > size - offset) {
+            /* Incomplete frame */
+            return -1;
+        }
+        size_t length = ((size_t)data[offset] << 24) | ((size_t)data[offset + 1] << 16) | ((size_t)data[offset + 2] << 8) | (size_t)data[offset + 3];
+        offset += FRAME_FIELD_HEADER_SIZE;
+        if (length > size - offset) {
+            /* Incomplete frame */
+            return -1;
+        }
+        if (index < count) {
+            frame_field(&data[offset], length, &frame->fields[index]);
+        }
+        offset += length;
+    }
+    frame->size = offset;
+
+    return 0;
+}
@@ -0,0 +1,287 @@
+/**
+ * @file      inproc.c
+ * @brief     In-process queue carrying frames between instances of the same process
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "inproc.h"
+
+/******************************************************************************/
+/* Variables                                                                  */
+/******************************************************************************/
+
+/* Queues registered in the process */
+static inproc_t *inproc_first = NULL;
+
+/* Mutex used to protect the registry, it can't be a semaphore because it is initialized statically */
+static pthread_mutex_t inproc_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Search a queue in the registry, the registry should be locked
+ * @param name Name of the queue
+ * @return Queue instance if it is registered, NULL otherwise
+ */
+static inproc_t *inproc_search(char *name);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a queue and to register it in the process
+ * @param name Name of the queue
+ * @return Queue instance if the function succeeded, NULL if the name is already registered or on error
+ */
+inproc_t *
+inproc_create(char *name) {
+
+    assert(NULL != name);
+
+    /* Create queue instance */
+    inproc_t *inproc = (inproc_t *)malloc(sizeof(inproc_t));
+    if (NULL == inproc) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(inproc, 0, sizeof(inproc_t));
+
+    /* The queue always holds a node preceding the first data to read */
+    inproc_node_t *stub = (inproc_node_t *)malloc(sizeof(inproc_node_t));
+    if (NULL == stub) {
+        /* Unable to allocate memory */
+        free(inproc);
+        return NULL;
+    }
+    memset(stub, 0, sizeof(inproc_node_t));
+    atomic_init(&stub->next, NULL);
+    inproc->head = stub;
+    atomic_init(&inproc->tail, stub);
+    atomic_init(&inproc->refcount, 1);
+    atomic_init(&inproc->signal, 0);
+    atomic_init(&inproc->waiting, 0);
+    atomic_init(&inproc->consumer, false);
+    if (NULL == (inproc->name = strdup(name))) {
+        /* Unable to allocate memory */
+        free(stub);
+        free(inproc);
+        return NULL;
+    }
+
+    /* Register the queue, the name should be unique in the process */
+    pthread_mutex_lock(&inproc_mutex);
+    if (NULL != inproc_search(name)) {
+        /* Name already registered */
+        pthread_mutex_unlock(&inproc_mutex);
+        free(inproc->name);
+        free(stub);
+        free(inproc);
+        return NULL;
+    }
+    inproc->next = inproc_first;
+    inproc_first = inproc;
+    pthread_mutex_unlock(&inproc_mutex);
+
+    return inproc;
+}
+
+/**
+ * @brief Function used to open a queue registered in the process
+ * @param name Name of the queue
+ * @return Queue instance if the function succeeded, NULL if the queue is not registered yet
+ */
+inproc_t *
+inproc_open(char *name) {
+
+    assert(NULL != name);
+
+    /* Search the queue and take a reference */
+    pthread_mutex_lock(&inproc_mutex);
+    inproc_t *inproc = inproc_search(name);
+    if (NULL != inproc) {
+        atomic_fetch_add(&inproc->refcount, 1);
+    }
+    pthread_mutex_unlock(&inproc_mutex);
+
+    return inproc;
+}
+
+/**
+ * @brief Write data to the queue, the data are not copied and the function never waits
+ * @param inproc Queue instance
+ * @param buffer Data to write, released with the queue if they are not read
+ * @param size Size of the data
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+inproc_write(inproc_t *inproc, void *buffer, size_t size) {
+
+    assert(NULL != inproc);
+    assert((NULL != buffer) || (0 == size));
+
+    /* Create new node */
+    inproc_node_t *node = (inproc_node_t *)malloc(sizeof(inproc_node_t));
+    if (NULL == node) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    atomic_init(&node->next, NULL);
+    node->buffer = buffer;
+    node->size   = size;
+
+    /* Append the node, producers only contend on the exchange of the tail */
+    inproc_node_t *prev = atomic_exchange_explicit(&inproc->tail, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+
+    /* Wake up the consumer if it is waiting */
+    atomic_fetch_add(&inproc->signal, 1);
+    if (0 != atomic_load(&inproc->waiting)) {
+        syscall(SYS_futex, &inproc->signal, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Read the oldest data written to the queue, the function waits if the queue is empty
+ * @param inproc Queue instance
+ * @param buffer Data read, to be released by the caller, NULL if there is none
+ * @param size Size of the data
+ * @param timeout Maximum time to wait in milliseconds
+ * @return 0 if the function succeeded, -1 if no data has been read
+ */
+int
+inproc_read(inproc_t *inproc, void **buffer, size_t *size, int timeout) {
+
+    assert(NULL != inproc);
+    assert(NULL != buffer);
+    assert(NULL != size);
+
+    *buffer = NULL;
+    *size   = 0;
+
+    /* Wait for data, the producers wake up the consumer only if it is waiting */
+    inproc_node_t *next = atomic_load_explicit(&inproc->head->next, memory_order_acquire);
+    if (NULL == next) {
+        uint32_t signal = atomic_load(&inproc->signal);
+        atomic_store(&inproc->waiting, 1);
+        if (NULL == atomic_load(&inproc->head->next)) {
+            struct timespec ts = { timeout / 1000, (timeout % 1000) * 1000000 };
+            syscall(SYS_futex, &inproc->signal, FUTEX_WAIT_PRIVATE, signal, &ts, NULL, 0);
+        }
+        atomic_store(&inproc->waiting, 0);
+        if (NULL == (next = atomic_load_explicit(&inproc->head->next, memory_order_acquire))) {
+            /* Nothing to read, a producer may also be appending its node */
+            return -1;
+        }
+    }
+
+    /* Take the data, the node becomes the one preceding the next data to read */
+    *buffer      = next->buffer;
+    *size        = next->size;
+    next->buffer = NULL;
+    next->size   = 0;
+    free(inproc->head);
+    inproc->head = next;
+
+    return 0;
+}
+
+/**
+ * @brief Release a reference of the queue, the queue is freed with its pending data when no instance uses it anymore
+ * @param inproc Queue instance
+ * @param remove true to remove the queue from the registry so that its name can be created again, false otherwise
+ */
+void
+inproc_release(inproc_t *inproc, bool remove) {
+
+    /* Release queue instance */
+    if (NULL != inproc) {
+
+        /* Remove the queue from the registry if wanted or when it is not used anymore, the registry is locked so that the queue can't be opened meanwhile */
+        pthread_mutex_lock(&inproc_mutex);
+        bool last = (1 == atomic_fetch_sub(&inproc->refcount, 1));
+        if (((true == remove) || (true == last)) && (false == inproc->removed)) {
+            inproc_t **curr = &inproc_first;
+            while ((NULL != *curr) && (inproc != *curr)) {
+                curr = &(*curr)->next;
+            }
+            if (NULL != *curr) {
+                *curr = inproc->next;
+            }
+            inproc->removed = true;
+        }
+        pthread_mutex_unlock(&inproc_mutex);
+
+        /* Release the pending data and the queue once it is not used anymore */
+        if (true == last) {
+            inproc_node_t *node = inproc->head;
+            while (NULL != node) {
+                inproc_node_t *tmp = node;
+                node               = atomic_load(&node->next);
+                free(tmp->buffer);
+                free(tmp);
+            }
+            free(inproc->name);
+            free(inproc);
+        }
+    }
+}
+
+/**
+ * @brief Search a queue in the registry, the registry should be locked
+ * @param name Name of the queue
+ * @return Queue instance if it is registered, NULL otherwise
+ */
+static inproc_t *
+inproc_search(char *name) {
+
+    /* Parse the registry */
+    for (inproc_t *inproc = inproc_first; NULL != inproc; inproc = inproc->next) {
+        if (!strcmp(inproc->name, name)) {
+            return inproc;
+        }
+    }
+
+    return NULL;
+}
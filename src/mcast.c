@@ -0,0 +1,450 @@
+/**
+ * @file      mcast.c
+ * @brief     UDP multicast group carrying frames from a publisher to the subscribers of a LAN
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <assert.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "mcast.h"
+#include "frame.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Create a multicast instance
+ * @param sender true if datagrams are sent to the group, false if they are received
+ * @return Multicast instance if the function succeeded, NULL otherwise
+ */
+static mcast_t *mcast_create(bool sender);
+
+/**
+ * @brief Retrieve the sender of a datagram, a new entry replacing the oldest one is given if the sender is unknown
+ * @param mcast Multicast instance
+ * @param addr Address of the sender
+ * @return Sender entry, not used if the sender is new
+ */
+static mcast_source_t *mcast_source(mcast_t *mcast, struct sockaddr_in *addr);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a multicast instance sending datagrams to a group
+ * @param group IPv4 address of the multicast group
+ * @param port Destination port
+ * @param interface IPv4 address of the outgoing interface, NULL to use the default one
+ * @param ttl Time to live of the datagrams, 1 to stay on the local network
+ * @param loop true if the datagrams are also received by the subscribers of the host, false otherwise
+ * @param size Maximum size of the datagrams, including the header
+ * @return Multicast instance if the function succeeded, NULL otherwise
+ */
+mcast_t *
+mcast_create_sender(char *group, uint16_t port, char *interface, int ttl, bool loop, size_t size) {
+
+    assert(NULL != group);
+
+    /* Check the group address */
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(struct sockaddr_in));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    if ((1 != inet_pton(AF_INET, group, &addr.sin_addr)) || (!IN_MULTICAST(ntohl(addr.sin_addr.s_addr)))) {
+        /* Invalid group */
+        return NULL;
+    }
+
+    /* Create multicast instance */
+    mcast_t *mcast = mcast_create(true);
+    if (NULL == mcast) {
+        /* Unable to create multicast instance */
+        return NULL;
+    }
+    mcast->size = (MCAST_HEADER_SIZE >= size) ? MCAST_SIZE : ((MCAST_DATAGRAM_SIZE < size) ? MCAST_DATAGRAM_SIZE : size);
+
+    /* Set the time to live, the loopback and the outgoing interface of the datagrams */
+    unsigned char value = (unsigned char)loop;
+    if ((0 > setsockopt(mcast->socket, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)))
+        || (0 > setsockopt(mcast->socket, IPPROTO_IP, IP_MULTICAST_LOOP, &value, sizeof(value)))) {
+        /* Unable to set socket options */
+        mcast_release(mcast);
+        return NULL;
+    }
+    if (NULL != interface) {
+        struct in_addr iface;
+        if ((1 != inet_pton(AF_INET, interface, &iface)) || (0 > setsockopt(mcast->socket, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)))) {
+            /* Unable to set the outgoing interface */
+            mcast_release(mcast);
+            return NULL;
+        }
+    }
+
+    /* Connect the socket to the group so that the datagrams are sent without destination */
+    if (0 > connect(mcast->socket, (struct sockaddr *)&addr, sizeof(struct sockaddr_in))) {
+        /* Unable to connect the socket */
+        mcast_release(mcast);
+        return NULL;
+    }
+
+    return mcast;
+}
+
+/**
+ * @brief Function used to create a multicast instance receiving the datagrams sent to a group
+ * @param group IPv4 address of the multicast group
+ * @param port Port on which the datagrams are received
+ * @param interface IPv4 address of the interface joining the group, NULL to use the default one
+ * @return Multicast instance if the function succeeded, NULL otherwise
+ */
+mcast_t *
+mcast_create_receiver(char *group, uint16_t port, char *interface) {
+
+    assert(NULL != group);
+
+    /* Check the group and interface addresses */
+    struct ip_mreq mreq;
+    memset(&mreq, 0, sizeof(struct ip_mreq));
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if ((1 != inet_pton(AF_INET, group, &mreq.imr_multiaddr)) || (!IN_MULTICAST(ntohl(mreq.imr_multiaddr.s_addr)))
+        || ((NULL != interface) && (1 != inet_pton(AF_INET, interface, &mreq.imr_interface)))) {
+        /* Invalid group or interface */
+        return NULL;
+    }
+
+    /* Create multicast instance */
+    mcast_t *mcast = mcast_create(false);
+    if (NULL == mcast) {
+        /* Unable to create multicast instance */
+        return NULL;
+    }
+    if (NULL == (mcast->buffers = (uint8_t *)malloc(MCAST_BATCH * MCAST_DATAGRAM_SIZE))) {
+        /* Unable to allocate memory */
+        mcast_release(mcast);
+        return NULL;
+    }
+
+    /* Bind the group address so that several receivers of the host share the port and only the datagrams of the group are received */
+    int                option = 1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(struct sockaddr_in));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    addr.sin_addr   = mreq.imr_multiaddr;
+    if ((0 > setsockopt(mcast->socket, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option)))
+        || (0 > bind(mcast->socket, (struct sockaddr *)&addr, sizeof(struct sockaddr_in)))) {
+        /* Unable to bind the socket */
+        mcast_release(mcast);
+        return NULL;
+    }
+
+    /* Join the group */
+    if (0 > setsockopt(mcast->socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(struct ip_mreq))) {
+        /* Unable to join the group */
+        mcast_release(mcast);
+        return NULL;
+    }
+
+    return mcast;
+}
+
+/**
+ * @brief Send frames to the group, they are packed in datagrams and never split
+ * @param mcast Multicast instance
+ * @param buffer Frames to send
+ * @param size Size of the frames
+ * @return 0 if the function succeeded, -1 otherwise, the frames too large for a datagram are skipped and the other ones are sent
+ */
+int
+mcast_send(mcast_t *mcast, void *buffer, size_t size) {
+
+    assert(NULL != mcast);
+    assert(NULL != buffer);
+
+    uint8_t        headers[MCAST_BATCH][MCAST_HEADER_SIZE];
+    struct iovec   iov[MCAST_BATCH][2];
+    struct mmsghdr msgs[MCAST_BATCH];
+    unsigned int   count   = 0;
+    int            ret     = 0;
+    bool           skipped = false;
+
+    /* Senders are serialized so that the sequence numbers are sent in order */
+    sem_wait(&mcast->sem);
+
+    /* Pack the frames in datagrams, a datagram holds contiguous frames of the buffer after its header */
+    uint8_t *curr = (uint8_t *)buffer;
+    while ((0 < size) && (0 == ret)) {
+
+        /* Add the frames fitting in the datagram, the first one is always added and sent alone if it is larger */
+        size_t  length = 0;
+        frame_t frame;
+        while ((length < size) && (0 == frame_peek(curr + length, size - length, &frame))
+               && ((0 == length) || (MCAST_HEADER_SIZE + length + frame.size <= mcast->size))) {
+            length += frame.size;
+        }
+        if (0 == length) {
+            /* Invalid frame */
+            ret = -1;
+            break;
+        }
+
+        /* Fill the header and the datagram, a frame too large for a datagram is skipped and the next ones are sent */
+        if (MCAST_DATAGRAM_SIZE < MCAST_HEADER_SIZE + length) {
+            skipped = true;
+        } else {
+            uint8_t *header = headers[count];
+            for (int index = 0; index < 4; index++) {
+                header[index] = (uint8_t)(mcast->session >> (8 * (3 - index)));
+            }
+            for (int index = 0; index < 8; index++) {
+                header[4 + index] = (uint8_t)(mcast->sequence >> (8 * (7 - index)));
+            }
+            mcast->sequence++;
+            iov[count][0].iov_base = header;
+            iov[count][0].iov_len  = MCAST_HEADER_SIZE;
+            iov[count][1].iov_base = curr;
+            iov[count][1].iov_len  = length;
+            memset(&msgs[count], 0, sizeof(struct mmsghdr));
+            msgs[count].msg_hdr.msg_iov    = iov[count];
+            msgs[count].msg_hdr.msg_iovlen = 2;
+            count++;
+        }
+        curr += length;
+        size -= length;
+
+        /* Send the datagrams at once when the batch is full or when all the frames are packed */
+        if ((0 < count) && ((MCAST_BATCH == count) || (0 == size))) {
+            unsigned int sent = 0;
+            while (sent < count) {
+                int n = sendmmsg(mcast->socket, &msgs[sent], count - sent, 0);
+                if (0 > n) {
+                    if (EINTR == errno) {
+                        continue;
+                    }
+                    /* Unable to send data, the datagrams are reported lost by the receivers */
+                    ret = -1;
+                    break;
+                }
+                sent += (unsigned int)n;
+            }
+            count = 0;
+        }
+    }
+
+    /* Release semaphore */
+    sem_post(&mcast->sem);
+
+    return (true == skipped) ? -1 : ret;
+}
+
+/**
+ * @brief Receive the datagrams available, the function waits if there is none
+ * @param mcast Multicast instance
+ * @param buffer Frames of the datagrams concatenated, to be released by the caller, NULL if there is none
+ * @param size Size of the frames
+ * @param lost Amount of datagrams lost detected using the sequence numbers
+ * @param timeout Maximum time to wait in milliseconds
+ * @return 0 if the function succeeded, -1 if no frame has been received
+ */
+int
+mcast_receive(mcast_t *mcast, void **buffer, size_t *size, uint64_t *lost, int timeout) {
+
+    assert(NULL != mcast);
+    assert(NULL != buffer);
+    assert(NULL != size);
+    assert(NULL != lost);
+
+    struct iovec       iov[MCAST_BATCH];
+    struct mmsghdr     msgs[MCAST_BATCH];
+    struct sockaddr_in addrs[MCAST_BATCH];
+
+    *buffer = NULL;
+    *size   = 0;
+    *lost   = 0;
+
+    /* Wait for datagrams */
+    struct pollfd fds = { mcast->socket, POLLIN, 0 };
+    if (0 >= poll(&fds, 1, timeout)) {
+        /* Timeout or interrupted */
+        return -1;
+    }
+
+    /* Receive the datagrams available at once */
+    memset(msgs, 0, sizeof(msgs));
+    for (int index = 0; index < MCAST_BATCH; index++) {
+        iov[index].iov_base             = &mcast->buffers[index * MCAST_DATAGRAM_SIZE];
+        iov[index].iov_len              = MCAST_DATAGRAM_SIZE;
+        msgs[index].msg_hdr.msg_iov     = &iov[index];
+        msgs[index].msg_hdr.msg_iovlen  = 1;
+        msgs[index].msg_hdr.msg_name    = &addrs[index];
+        msgs[index].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    }
+    int count = recvmmsg(mcast->socket, msgs, MCAST_BATCH, MSG_DONTWAIT, NULL);
+    if (0 >= count) {
+        /* Unable to receive data */
+        return -1;
+    }
+
+    /* Allocate memory for the frames of all the datagrams */
+    size_t total = 0;
+    for (int index = 0; index < count; index++) {
+        total += (MCAST_HEADER_SIZE < msgs[index].msg_len) ? msgs[index].msg_len - MCAST_HEADER_SIZE : 0;
+    }
+    if ((0 == total) || (NULL == (*buffer = malloc(total)))) {
+        /* No frame or unable to allocate memory */
+        return -1;
+    }
+
+    /* Check the sequence numbers of the datagrams and concatenate their frames, late and duplicated datagrams are dropped */
+    for (int index = 0; index < count; index++) {
+        uint8_t *data = (uint8_t *)iov[index].iov_base;
+        if (MCAST_HEADER_SIZE >= msgs[index].msg_len) {
+            /* Invalid datagram */
+            continue;
+        }
+        uint32_t session  = 0;
+        uint64_t sequence = 0;
+        for (int i = 0; i < 4; i++) {
+            session = (session << 8) | data[i];
+        }
+        for (int i = 0; i < 8; i++) {
+            sequence = (sequence << 8) | data[4 + i];
+        }
+        mcast_source_t *source = mcast_source(mcast, &addrs[index]);
+        if ((true == source->used) && (session == source->session)) {
+            if (sequence < source->sequence) {
+                /* Late or duplicated datagram */
+                continue;
+            }
+            *lost += sequence - source->sequence;
+        }
+        source->used     = true;
+        source->session  = session;
+        source->sequence = sequence + 1;
+        memcpy((uint8_t *)*buffer + *size, &data[MCAST_HEADER_SIZE], msgs[index].msg_len - MCAST_HEADER_SIZE);
+        *size += msgs[index].msg_len - MCAST_HEADER_SIZE;
+    }
+    if (0 == *size) {
+        /* All the datagrams are dropped */
+        free(*buffer);
+        *buffer = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Release multicast instance
+ * @param mcast Multicast instance
+ */
+void
+mcast_release(mcast_t *mcast) {
+
+    /* Release multicast instance */
+    if (NULL != mcast) {
+        close(mcast->socket);
+        sem_close(&mcast->sem);
+        free(mcast->buffers);
+        free(mcast);
+    }
+}
+
+/**
+ * @brief Create a multicast instance
+ * @param sender true if datagrams are sent to the group, false if they are received
+ * @return Multicast instance if the function succeeded, NULL otherwise
+ */
+static mcast_t *
+mcast_create(bool sender) {
+
+    /* Create multicast instance */
+    mcast_t *mcast = (mcast_t *)malloc(sizeof(mcast_t));
+    if (NULL == mcast) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(mcast, 0, sizeof(mcast_t));
+    if (0 > (mcast->socket = socket(AF_INET, SOCK_DGRAM, 0))) {
+        /* Unable to create the socket */
+        free(mcast);
+        return NULL;
+    }
+    mcast->sender = sender;
+
+    /* The session distinguishes the restarts of the sender, the receivers then follow the new sequence numbers */
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    mcast->session = (uint32_t)getpid() ^ (uint32_t)ts.tv_nsec ^ (uint32_t)ts.tv_sec;
+
+    /* Initialize semaphore used to serialize the senders */
+    sem_init(&mcast->sem, 0, 1);
+
+    return mcast;
+}
+
+/**
+ * @brief Retrieve the sender of a datagram, a new entry replacing the oldest one is given if the sender is unknown
+ * @param mcast Multicast instance
+ * @param addr Address of the sender
+ * @return Sender entry, not used if the sender is new
+ */
+static mcast_source_t *
+mcast_source(mcast_t *mcast, struct sockaddr_in *addr) {
+
+    /* Search the sender */
+    for (int index = 0; index < MCAST_SOURCES; index++) {
+        mcast_source_t *source = &mcast->sources.entries[index];
+        if ((true == source->used) && (addr->sin_addr.s_addr == source->address) && (addr->sin_port == source->port)) {
+            return source;
+        }
+    }
+
+    /* New sender, replace the oldest entry */
+    mcast_source_t *source = &mcast->sources.entries[mcast->sources.next];
+    mcast->sources.next    = (mcast->sources.next + 1) % MCAST_SOURCES;
+    memset(source, 0, sizeof(mcast_source_t));
+    source->address = addr->sin_addr.s_addr;
+    source->port    = addr->sin_port;
+
+    return source;
+}
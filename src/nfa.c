@@ -0,0 +1,678 @@
+/**
+ * @file      nfa.c
+ * @brief     Compilation of extended regular expressions to non-deterministic automatons
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "nfa.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Parse an alternation
+ * @param nfa NFA instance
+ * @param pattern Pattern, updated to the end of the alternation
+ * @param frag Fragment of the alternation
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int nfa_parse_alternation(nfa_t *nfa, char **pattern, nfa_frag_t *frag);
+
+/**
+ * @brief Parse a concatenation
+ * @param nfa NFA instance
+ * @param pattern Pattern, updated to the end of the concatenation
+ * @param frag Fragment of the concatenation
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int nfa_parse_concatenation(nfa_t *nfa, char **pattern, nfa_frag_t *frag);
+
+/**
+ * @brief Parse an atom followed by its repetitions
+ * @param nfa NFA instance
+ * @param pattern Pattern, updated to the end of the repetitions
+ * @param frag Fragment of the repeated atom
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int nfa_parse_repetition(nfa_t *nfa, char **pattern, nfa_frag_t *frag);
+
+/**
+ * @brief Parse an atom
+ * @param nfa NFA instance
+ * @param pattern Pattern, updated to the end of the atom
+ * @param frag Fragment of the atom
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int nfa_parse_atom(nfa_t *nfa, char **pattern, nfa_frag_t *frag);
+
+/**
+ * @brief Parse a bracket expression
+ * @param pattern Pattern starting after the opening bracket, updated to the end of the bracket expression
+ * @param set Set of characters of the bracket expression
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int nfa_parse_bracket(char **pattern, uint8_t *set);
+
+/**
+ * @brief Parse a bound
+ * @param pattern Pattern starting after the opening brace, updated to the end of the bound
+ * @param min Minimum amount of repetitions
+ * @param max Maximum amount of repetitions, -1 if it is not bounded
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int nfa_parse_bound(char **pattern, int *min, int *max);
+
+/**
+ * @brief Create a new state
+ * @param nfa NFA instance
+ * @param type State type
+ * @param out Next state
+ * @param out1 Second next state
+ * @return New state if the function succeeded, -1 otherwise
+ */
+static int nfa_state_create(nfa_t *nfa, nfa_type_e type, int out, int out1);
+
+/**
+ * @brief Create a fragment made of a single state followed by the end state
+ * @param nfa NFA instance
+ * @param type State type
+ * @param frag Fragment
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int nfa_frag_create(nfa_t *nfa, nfa_type_e type, nfa_frag_t *frag);
+
+/**
+ * @brief Copy a fragment, the states of the fragment are the ones created since the first state
+ * @param nfa NFA instance
+ * @param frag Fragment to be copied
+ * @param first First state of the fragment
+ * @param last State following the last state of the fragment
+ * @param copy Copy of the fragment
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int nfa_frag_copy(nfa_t *nfa, nfa_frag_t *frag, int first, int last, nfa_frag_t *copy);
+
+/**
+ * @brief Repeat a fragment
+ * @param nfa NFA instance
+ * @param frag Fragment to be repeated, updated with the repeated fragment
+ * @param first First state of the fragment
+ * @param min Minimum amount of repetitions
+ * @param max Maximum amount of repetitions, -1 if it is not bounded
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int nfa_frag_repeat(nfa_t *nfa, nfa_frag_t *frag, int first, int min, int max);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to compile an extended regular expression to a NFA instance
+ * Supported syntax is characters, escaped metacharacters, '.', bracket expressions with ranges and character classes, groups, alternations, anchors and
+ * '*', '+', '?' and bounded repetitions. Other syntaxes are rejected so that the regular expression is executed using regexec instead.
+ * @param pattern Regular expression, it must have been compiled successfully using regcomp before
+ * @return NFA instance if the function succeeded, NULL otherwise
+ */
+nfa_t *
+nfa_create(char *pattern) {
+
+    assert(NULL != pattern);
+
+    /* Automatons consume bytes, they are not used if characters may be encoded on several bytes */
+    if (1 < MB_CUR_MAX) {
+        return NULL;
+    }
+
+    /* Create NFA instance */
+    nfa_t *nfa = (nfa_t *)malloc(sizeof(nfa_t));
+    if (NULL == nfa) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(nfa, 0, sizeof(nfa_t));
+
+    /* Parse the pattern */
+    nfa_frag_t frag;
+    if ((0 != nfa_parse_alternation(nfa, &pattern, &frag)) || ('\0' != *pattern)) {
+        /* Unsupported syntax */
+        nfa_release(nfa);
+        return NULL;
+    }
+
+    /* Terminate the automaton */
+    int match = nfa_state_create(nfa, NFA_TYPE_MATCH, -1, -1);
+    if (0 > match) {
+        /* Unable to allocate memory */
+        nfa_release(nfa);
+        return NULL;
+    }
+    nfa->states[frag.end].out = match;
+    nfa->start                = frag.start;
+
+    return nfa;
+}
+
+/**
+ * @brief Release NFA instance
+ * @param nfa NFA instance
+ */
+void
+nfa_release(nfa_t *nfa) {
+
+    /* Release NFA instance */
+    if (NULL != nfa) {
+        free(nfa->states);
+        free(nfa);
+    }
+}
+
+/**
+ * @brief Parse an alternation
+ * @param nfa NFA instance
+ * @param pattern Pattern, updated to the end of the alternation
+ * @param frag Fragment of the alternation
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+nfa_parse_alternation(nfa_t *nfa, char **pattern, nfa_frag_t *frag) {
+
+    /* Parse the first branch */
+    if (0 != nfa_parse_concatenation(nfa, pattern, frag)) {
+        return -1;
+    }
+
+    /* Parse the other branches */
+    while ('|' == **pattern) {
+        (*pattern)++;
+        nfa_frag_t branch;
+        if (0 != nfa_parse_concatenation(nfa, pattern, &branch)) {
+            return -1;
+        }
+        int end   = nfa_state_create(nfa, NFA_TYPE_EMPTY, -1, -1);
+        int start = nfa_state_create(nfa, NFA_TYPE_SPLIT, frag->start, branch.start);
+        if ((0 > end) || (0 > start)) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        nfa->states[frag->end].out  = end;
+        nfa->states[branch.end].out = end;
+        frag->start                 = start;
+        frag->end                   = end;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Parse a concatenation
+ * @param nfa NFA instance
+ * @param pattern Pattern, updated to the end of the concatenation
+ * @param frag Fragment of the concatenation
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+nfa_parse_concatenation(nfa_t *nfa, char **pattern, nfa_frag_t *frag) {
+
+    /* An empty concatenation matches the empty string */
+    if (0 != nfa_frag_create(nfa, NFA_TYPE_EMPTY, frag)) {
+        return -1;
+    }
+
+    /* Parse all the repetitions */
+    while (('\0' != **pattern) && ('|' != **pattern) && (')' != **pattern)) {
+        nfa_frag_t next;
+        if (0 != nfa_parse_repetition(nfa, pattern, &next)) {
+            return -1;
+        }
+        nfa->states[frag->end].out = next.start;
+        frag->end                  = next.end;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Parse an atom followed by its repetitions
+ * @param nfa NFA instance
+ * @param pattern Pattern, updated to the end of the repetitions
+ * @param frag Fragment of the repeated atom
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+nfa_parse_repetition(nfa_t *nfa, char **pattern, nfa_frag_t *frag) {
+
+    /* Parse the atom */
+    char c     = **pattern;
+    int  first = (int)nfa->count;
+    if (0 != nfa_parse_atom(nfa, pattern, frag)) {
+        return -1;
+    }
+
+    /* Parse the repetitions, each one applies to the previous ones */
+    while ((NULL != strchr("*+?{", **pattern)) && ('\0' != **pattern)) {
+        if (('^' == c) || ('$' == c)) {
+            /* Repetition of an anchor */
+            return -1;
+        }
+        int min = 0, max = -1;
+        if ('*' == **pattern) {
+            (*pattern)++;
+        } else if ('+' == **pattern) {
+            (*pattern)++;
+            min = 1;
+        } else if ('?' == **pattern) {
+            (*pattern)++;
+            max = 1;
+        } else {
+            (*pattern)++;
+            if (0 != nfa_parse_bound(pattern, &min, &max)) {
+                return -1;
+            }
+        }
+        if (0 != nfa_frag_repeat(nfa, frag, first, min, max)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Parse an atom
+ * @param nfa NFA instance
+ * @param pattern Pattern, updated to the end of the atom
+ * @param frag Fragment of the atom
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+nfa_parse_atom(nfa_t *nfa, char **pattern, nfa_frag_t *frag) {
+
+    char c = *(*pattern)++;
+
+    /* Groups */
+    if ('(' == c) {
+        if (0 != nfa_parse_alternation(nfa, pattern, frag)) {
+            return -1;
+        }
+        if (')' != **pattern) {
+            /* Unbalanced parenthesis */
+            return -1;
+        }
+        (*pattern)++;
+        return 0;
+    }
+
+    /* Anchors */
+    if ('^' == c) {
+        return nfa_frag_create(nfa, NFA_TYPE_BOL, frag);
+    }
+    if ('$' == c) {
+        return nfa_frag_create(nfa, NFA_TYPE_EOL, frag);
+    }
+
+    /* Other atoms consume a character */
+    uint8_t set[32];
+    memset(set, 0, sizeof(set));
+    if ('.' == c) {
+        memset(set, 0xFF, sizeof(set));
+    } else if ('[' == c) {
+        if (0 != nfa_parse_bracket(pattern, set)) {
+            return -1;
+        }
+    } else if (('\\' == c) && ('\0' != **pattern) && (NULL != strchr(NFA_METACHARACTERS, **pattern))) {
+        c = *(*pattern)++;
+        set[(unsigned char)c >> 3] |= (uint8_t)(1 << ((unsigned char)c & 7));
+    } else if ((NULL == strchr("()*+?{|\\", c)) && ('\0' != c)) {
+        set[(unsigned char)c >> 3] |= (uint8_t)(1 << ((unsigned char)c & 7));
+    } else {
+        /* Unsupported syntax */
+        return -1;
+    }
+    if (0 != nfa_frag_create(nfa, NFA_TYPE_CHAR, frag)) {
+        return -1;
+    }
+    memcpy(nfa->states[frag->start].set, set, sizeof(set));
+
+    return 0;
+}
+
+/**
+ * @brief Parse a bracket expression
+ * @param pattern Pattern starting after the opening bracket, updated to the end of the bracket expression
+ * @param set Set of characters of the bracket expression
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+nfa_parse_bracket(char **pattern, uint8_t *set) {
+
+    static const struct {
+        char *name;
+        int (*fct)(int);
+    } classes[] = { { "alnum", isalnum }, { "alpha", isalpha }, { "blank", isblank }, { "cntrl", iscntrl },
+                    { "digit", isdigit }, { "graph", isgraph }, { "lower", islower }, { "print", isprint },
+                    { "punct", ispunct }, { "space", isspace }, { "upper", isupper }, { "xdigit", isxdigit } };
+
+    char *curr   = *pattern;
+    bool  negate = false;
+
+    /* Check if the bracket expression is negated */
+    if ('^' == *curr) {
+        negate = true;
+        curr++;
+    }
+
+    /* Parse the items, a closing bracket at the beginning is a character */
+    do {
+        if ('\0' == *curr) {
+            /* Unbalanced bracket */
+            return -1;
+        }
+        if (('[' == curr[0]) && (':' == curr[1])) {
+
+            /* Character class */
+            char *end = strstr(curr + 2, ":]");
+            if (NULL == end) {
+                return -1;
+            }
+            size_t index = 0;
+            while ((index < sizeof(classes) / sizeof(classes[0]))
+                   && ((strlen(classes[index].name) != (size_t)(end - curr - 2)) || (0 != strncmp(classes[index].name, curr + 2, end - curr - 2)))) {
+                index++;
+            }
+            if (index == sizeof(classes) / sizeof(classes[0])) {
+                /* Unknown class */
+                return -1;
+            }
+            for (int c = 1; c < 256; c++) {
+                if (0 != classes[index].fct(c)) {
+                    set[c >> 3] |= (uint8_t)(1 << (c & 7));
+                }
+            }
+            curr = end + 2;
+
+        } else if (('[' == curr[0]) && (('=' == curr[1]) || ('.' == curr[1]))) {
+
+            /* Equivalence classes and collating symbols are not supported */
+            return -1;
+
+        } else {
+
+            /* Character or range of characters, a dash is a character only at the beginning or at the end */
+            if (('-' == curr[0]) && (curr != *pattern + (negate ? 1 : 0)) && (']' != curr[1])) {
+                return -1;
+            }
+            unsigned char from = (unsigned char)*curr++;
+            unsigned char to   = from;
+            if (('-' == curr[0]) && (']' != curr[1]) && ('\0' != curr[1])) {
+                if ('[' == curr[1]) {
+                    /* Range ending with a class or a collating symbol */
+                    return -1;
+                }
+                to = (unsigned char)curr[1];
+                curr += 2;
+            }
+            if (from > to) {
+                /* Invalid range */
+                return -1;
+            }
+            for (int c = from; c <= to; c++) {
+                set[c >> 3] |= (uint8_t)(1 << (c & 7));
+            }
+        }
+    } while (']' != *curr);
+    *pattern = curr + 1;
+
+    /* Complement the set if it is negated */
+    if (true == negate) {
+        for (size_t index = 0; index < 32; index++) {
+            set[index] = (uint8_t)~set[index];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Parse a bound
+ * @param pattern Pattern starting after the opening brace, updated to the end of the bound
+ * @param min Minimum amount of repetitions
+ * @param max Maximum amount of repetitions, -1 if it is not bounded
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+nfa_parse_bound(char **pattern, int *min, int *max) {
+
+    char *curr = *pattern;
+
+    /* Minimum, 0 if it is omitted */
+    *min = 0;
+    while (isdigit((unsigned char)*curr)) {
+        *min = 10 * (*min) + (*curr++ - '0');
+        if (NFA_STATES_MAX < *min) {
+            return -1;
+        }
+    }
+
+    /* Maximum, same as minimum if there is no comma and unbounded if it is omitted after the comma */
+    if (',' == *curr) {
+        curr++;
+        if (isdigit((unsigned char)*curr)) {
+            *max = 0;
+            while (isdigit((unsigned char)*curr)) {
+                *max = 10 * (*max) + (*curr++ - '0');
+                if (NFA_STATES_MAX < *max) {
+                    return -1;
+                }
+            }
+        } else {
+            *max = -1;
+        }
+    } else {
+        *max = *min;
+    }
+    if (('}' != *curr) || (curr == *pattern) || ((0 <= *max) && (*min > *max))) {
+        /* Invalid bound */
+        return -1;
+    }
+    *pattern = curr + 1;
+
+    return 0;
+}
+
+/**
+ * @brief Create a new state
+ * @param nfa NFA instance
+ * @param type State type
+ * @param out Next state
+ * @param out1 Second next state
+ * @return New state if the function succeeded, -1 otherwise
+ */
+static int
+nfa_state_create(nfa_t *nfa, nfa_type_e type, int out, int out1) {
+
+    /* Limit the size of the automaton */
+    if (NFA_STATES_MAX <= nfa->count) {
+        return -1;
+    }
+
+    /* Grow the states array if it is full */
+    if (nfa->count == nfa->capacity) {
+        size_t       capacity = (0 < nfa->capacity) ? (2 * nfa->capacity) : 16;
+        nfa_state_t *states   = (nfa_state_t *)realloc(nfa->states, capacity * sizeof(nfa_state_t));
+        if (NULL == states) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        nfa->states   = states;
+        nfa->capacity = capacity;
+    }
+
+    /* Initialize the state */
+    int state = (int)nfa->count++;
+    memset(&nfa->states[state], 0, sizeof(nfa_state_t));
+    nfa->states[state].type = type;
+    nfa->states[state].out  = out;
+    nfa->states[state].out1 = out1;
+
+    return state;
+}
+
+/**
+ * @brief Create a fragment made of a single state followed by the end state
+ * @param nfa NFA instance
+ * @param type State type
+ * @param frag Fragment
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+nfa_frag_create(nfa_t *nfa, nfa_type_e type, nfa_frag_t *frag) {
+
+    /* Create the end state */
+    if (0 > (frag->end = nfa_state_create(nfa, NFA_TYPE_EMPTY, -1, -1))) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    /* Create the state, an empty fragment is made of the end state only */
+    if (NFA_TYPE_EMPTY == type) {
+        frag->start = frag->end;
+    } else if (0 > (frag->start = nfa_state_create(nfa, type, frag->end, -1))) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Copy a fragment, the states of the fragment are the ones created since the first state
+ * @param nfa NFA instance
+ * @param frag Fragment to be copied
+ * @param first First state of the fragment
+ * @param last State following the last state of the fragment
+ * @param copy Copy of the fragment
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+nfa_frag_copy(nfa_t *nfa, nfa_frag_t *frag, int first, int last, nfa_frag_t *copy) {
+
+    int offset = (int)nfa->count - first;
+
+    /* Copy the states, links inside of the fragment are relocated */
+    for (int state = first; state < last; state++) {
+        int out  = nfa->states[state].out;
+        int out1 = nfa->states[state].out1;
+        int curr = nfa_state_create(nfa,
+                                    nfa->states[state].type,
+                                    ((first <= out) && (out < last)) ? (out + offset) : -1,
+                                    ((first <= out1) && (out1 < last)) ? (out1 + offset) : -1);
+        if (0 > curr) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        memcpy(nfa->states[curr].set, nfa->states[state].set, sizeof(nfa->states[curr].set));
+    }
+
+    /* The end state of the copy has no next state even if the fragment has already been linked */
+    copy->start                = frag->start + offset;
+    copy->end                  = frag->end + offset;
+    nfa->states[copy->end].out = -1;
+
+    return 0;
+}
+
+/**
+ * @brief Repeat a fragment
+ * @param nfa NFA instance
+ * @param frag Fragment to be repeated, updated with the repeated fragment
+ * @param first First state of the fragment
+ * @param min Minimum amount of repetitions
+ * @param max Maximum amount of repetitions, -1 if it is not bounded
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+nfa_frag_repeat(nfa_t *nfa, nfa_frag_t *frag, int first, int min, int max) {
+
+    nfa_frag_t unit = *frag;
+    int        last = (int)nfa->count;
+
+    /* Anchors in repeated fragments are not supported, regexec results are not consistent for them */
+    for (int state = first; state < last; state++) {
+        if ((NFA_TYPE_BOL == nfa->states[state].type) || (NFA_TYPE_EOL == nfa->states[state].type)) {
+            return -1;
+        }
+    }
+
+    /* The repeated fragment starts empty */
+    if (0 != nfa_frag_create(nfa, NFA_TYPE_EMPTY, frag)) {
+        return -1;
+    }
+
+    /* Append the mandatory and the optional occurrences, the fragment itself is used as the first one */
+    int count = (0 > max) ? ((0 < min) ? min : 1) : max;
+    for (int index = 0; index < count; index++) {
+        nfa_frag_t curr = unit;
+        if ((0 < index) && (0 != nfa_frag_copy(nfa, &unit, first, last, &curr))) {
+            return -1;
+        }
+        if ((index >= min) || ((0 > max) && (index == count - 1))) {
+
+            /* Optional occurrence, or last occurrence which can be repeated */
+            int end   = nfa_state_create(nfa, NFA_TYPE_EMPTY, -1, -1);
+            int split = nfa_state_create(nfa, NFA_TYPE_SPLIT, curr.start, end);
+            if ((0 > end) || (0 > split)) {
+                /* Unable to allocate memory */
+                return -1;
+            }
+            if (0 > max) {
+                /* Loop on the occurrence, it is mandatory if the minimum is not 0 */
+                nfa->states[curr.end].out = split;
+                curr.start                = (0 < min) ? curr.start : split;
+            } else {
+                /* Skip the occurrence */
+                nfa->states[curr.end].out = end;
+                curr.start                = split;
+            }
+            curr.end = end;
+        }
+        nfa->states[frag->end].out = curr.start;
+        frag->end                  = curr.end;
+    }
+
+    return 0;
+}
@@ -0,0 +1,381 @@
+/**
+ * @file      resolver.c
+ * @brief     Cache of the addresses of the hostnames, refreshed in the background
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <netdb.h>
+
+#include "resolver.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Thread used to resolve again the hostnames whose addresses are outdated or expired
+ * @param arg Resolver instance
+ * @return Always returns NULL
+ */
+static void *resolver_thread(void *arg);
+
+/**
+ * @brief Resolve a hostname with the system resolver
+ * @param hostname Hostname, IPv4 or IPv6 address
+ * @param port Port
+ * @param numeric true to only accept addresses, the function never waits then
+ * @param addrs Addresses filled by the function, at least RESOLVER_ADDRESSES entries
+ * @param sizes Sizes of the addresses filled by the function, at least RESOLVER_ADDRESSES entries
+ * @return Amount of addresses, 0 if the hostname can't be resolved
+ */
+static size_t resolver_resolve(char *hostname, uint16_t port, bool numeric, struct sockaddr_storage *addrs, socklen_t *sizes);
+
+/**
+ * @brief Search a hostname in the cache, the entries should be locked
+ * @param resolver Resolver instance
+ * @param hostname Hostname
+ * @param port Port
+ * @return Entry if it is found, NULL otherwise
+ */
+static resolver_entry_t *resolver_search(resolver_t *resolver, char *hostname, uint16_t port);
+
+/**
+ * @brief Retrieve the current time (CLOCK_MONOTONIC) in seconds
+ * @return Current time
+ */
+static time_t resolver_now(void);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a resolver instance
+ * @return Resolver instance if the function succeeded, NULL otherwise
+ */
+resolver_t *
+resolver_create(void) {
+
+    /* Create new resolver instance */
+    resolver_t *resolver = (resolver_t *)malloc(sizeof(resolver_t));
+    if (NULL == resolver) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(resolver, 0, sizeof(resolver_t));
+    resolver->refresh = RESOLVER_REFRESH;
+    atomic_init(&resolver->stop, false);
+
+    /* Initialize semaphores */
+    sem_init(&resolver->signal, 0, 0);
+    sem_init(&resolver->sem, 0, 1);
+
+    return resolver;
+}
+
+/**
+ * @brief Set the interval at which the hostnames are resolved again
+ * @param resolver Resolver instance
+ * @param refresh Interval in seconds, 0 to use the default one
+ */
+void
+resolver_set_refresh(resolver_t *resolver, unsigned int refresh) {
+
+    assert(NULL != resolver);
+
+    /* Record the interval */
+    sem_wait(&resolver->sem);
+    resolver->refresh = (0 < refresh) ? refresh : RESOLVER_REFRESH;
+    sem_post(&resolver->sem);
+}
+
+/**
+ * @brief Retrieve the addresses of a hostname, only the first lookup of a hostname waits for the system resolver
+ * @param resolver Resolver instance
+ * @param hostname Hostname, IPv4 or IPv6 address
+ * @param port Port
+ * @param addrs Addresses filled by the function, at least RESOLVER_ADDRESSES entries
+ * @param sizes Sizes of the addresses filled by the function, at least RESOLVER_ADDRESSES entries
+ * @return Amount of addresses, 0 if the hostname can't be resolved
+ */
+size_t
+resolver_lookup(resolver_t *resolver, char *hostname, uint16_t port, struct sockaddr_storage *addrs, socklen_t *sizes) {
+
+    assert(NULL != resolver);
+    assert(NULL != hostname);
+    assert(NULL != addrs);
+    assert(NULL != sizes);
+
+    /* Give the cached addresses if the hostname has already been resolved */
+    sem_wait(&resolver->sem);
+    resolver_entry_t *entry = resolver_search(resolver, hostname, port);
+    if (NULL != entry) {
+        size_t count = entry->count;
+        memcpy(addrs, entry->addrs, count * sizeof(struct sockaddr_storage));
+        memcpy(sizes, entry->sizes, count * sizeof(socklen_t));
+        sem_post(&resolver->sem);
+        return count;
+    }
+    sem_post(&resolver->sem);
+
+    /* Create new entry, addresses are resolved without lock because the system resolver may wait for the name servers */
+    entry = (resolver_entry_t *)malloc(sizeof(resolver_entry_t));
+    if (NULL == entry) {
+        /* Unable to allocate memory */
+        return 0;
+    }
+    memset(entry, 0, sizeof(resolver_entry_t));
+    if (NULL == (entry->hostname = strdup(hostname))) {
+        /* Unable to allocate memory */
+        free(entry);
+        return 0;
+    }
+    entry->port    = port;
+    entry->count   = resolver_resolve(hostname, port, true, entry->addrs, entry->sizes);
+    entry->numeric = (0 < entry->count);
+    if (false == entry->numeric) {
+        entry->count = resolver_resolve(hostname, port, false, entry->addrs, entry->sizes);
+    }
+    entry->refreshed = resolver_now();
+    entry->expired   = (0 == entry->count);
+
+    /* Add the entry, unless another thread has resolved the same hostname meanwhile */
+    sem_wait(&resolver->sem);
+    resolver_entry_t *tmp = resolver_search(resolver, hostname, port);
+    if (NULL != tmp) {
+        free(entry->hostname);
+        free(entry);
+        entry = tmp;
+    } else {
+        entry->next     = resolver->first;
+        resolver->first = entry;
+    }
+    size_t count = entry->count;
+    memcpy(addrs, entry->addrs, count * sizeof(struct sockaddr_storage));
+    memcpy(sizes, entry->sizes, count * sizeof(socklen_t));
+
+    /* Start the thread resolving the hostnames again, addresses never change */
+    if ((false == entry->numeric) && (false == resolver->started)) {
+        if (0 == pthread_create(&resolver->thread, NULL, resolver_thread, resolver)) {
+            resolver->started = true;
+        }
+    }
+    sem_post(&resolver->sem);
+
+    return count;
+}
+
+/**
+ * @brief Ask for the addresses of a hostname to be resolved again in the background, typically when none of them is reachable
+ * @param resolver Resolver instance
+ * @param hostname Hostname
+ * @param port Port
+ */
+void
+resolver_expire(resolver_t *resolver, char *hostname, uint16_t port) {
+
+    assert(NULL != resolver);
+    assert(NULL != hostname);
+
+    /* Mark the entry as expired and wake up the thread */
+    sem_wait(&resolver->sem);
+    resolver_entry_t *entry = resolver_search(resolver, hostname, port);
+    if ((NULL != entry) && (false == entry->numeric) && (false == entry->expired)) {
+        entry->expired = true;
+        sem_post(&resolver->signal);
+    }
+    sem_post(&resolver->sem);
+}
+
+/**
+ * @brief Release resolver instance
+ * @param resolver Resolver instance
+ */
+void
+resolver_release(resolver_t *resolver) {
+
+    /* Release resolver instance */
+    if (NULL != resolver) {
+
+        /* Stop the thread */
+        if (true == resolver->started) {
+            atomic_store(&resolver->stop, true);
+            sem_post(&resolver->signal);
+            pthread_join(resolver->thread, NULL);
+        }
+
+        /* Release entries */
+        resolver_entry_t *entry = resolver->first;
+        while (NULL != entry) {
+            resolver_entry_t *tmp = entry;
+            entry                 = entry->next;
+            free(tmp->hostname);
+            free(tmp);
+        }
+        sem_close(&resolver->signal);
+        sem_close(&resolver->sem);
+        free(resolver);
+    }
+}
+
+/**
+ * @brief Thread used to resolve again the hostnames whose addresses are outdated or expired
+ * @param arg Resolver instance
+ * @return Always returns NULL
+ */
+static void *
+resolver_thread(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Retrieve resolver instance */
+    resolver_t *resolver = (resolver_t *)arg;
+
+    /* Set thread name */
+    pthread_setname_np(pthread_self(), "axon-resolver");
+
+    /* Loop until the instance is released, the entries are checked each second or when addresses have expired */
+    while (false == atomic_load(&resolver->stop)) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += 1;
+        sem_timedwait(&resolver->signal, &ts);
+
+        /* Resolve the outdated hostnames, an expired hostname is resolved at most once per second, entries are never removed so they remain valid without lock */
+        time_t            now   = resolver_now();
+        resolver_entry_t *entry = NULL;
+        do {
+            sem_wait(&resolver->sem);
+            entry = (NULL == entry) ? resolver->first : entry->next;
+            while ((NULL != entry)
+                   && ((true == entry->numeric) || (now < entry->refreshed + ((true == entry->expired) ? 1 : (time_t)resolver->refresh)))) {
+                entry = entry->next;
+            }
+            sem_post(&resolver->sem);
+            if ((NULL != entry) && (false == atomic_load(&resolver->stop))) {
+                struct sockaddr_storage addrs[RESOLVER_ADDRESSES];
+                socklen_t               sizes[RESOLVER_ADDRESSES];
+                size_t                  count = resolver_resolve(entry->hostname, entry->port, false, addrs, sizes);
+
+                /* The previous addresses are kept if the hostname can't be resolved anymore */
+                sem_wait(&resolver->sem);
+                if (0 < count) {
+                    memcpy(entry->addrs, addrs, count * sizeof(struct sockaddr_storage));
+                    memcpy(entry->sizes, sizes, count * sizeof(socklen_t));
+                    entry->count = count;
+                }
+                entry->refreshed = resolver_now();
+                entry->expired   = (0 == entry->count);
+                sem_post(&resolver->sem);
+            }
+        } while (NULL != entry);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Resolve a hostname with the system resolver
+ * @param hostname Hostname, IPv4 or IPv6 address
+ * @param port Port
+ * @param numeric true to only accept addresses, the function never waits then
+ * @param addrs Addresses filled by the function, at least RESOLVER_ADDRESSES entries
+ * @param sizes Sizes of the addresses filled by the function, at least RESOLVER_ADDRESSES entries
+ * @return Amount of addresses, 0 if the hostname can't be resolved
+ */
+static size_t
+resolver_resolve(char *hostname, uint16_t port, bool numeric, struct sockaddr_storage *addrs, socklen_t *sizes) {
+
+    struct addrinfo  hints;
+    struct addrinfo *result = NULL;
+    char             service[8];
+    size_t           count = 0;
+
+    /* Resolve the hostname, IPv4 and IPv6 addresses are given in the order preferred by the system */
+    memset(&hints, 0, sizeof(struct addrinfo));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_NUMERICSERV | ((true == numeric) ? AI_NUMERICHOST : 0);
+    snprintf(service, sizeof(service), "%u", port);
+    if (0 != getaddrinfo(hostname, service, &hints, &result)) {
+        /* Unable to resolve the hostname */
+        return 0;
+    }
+
+    /* Copy the addresses */
+    for (struct addrinfo *curr = result; (NULL != curr) && (count < RESOLVER_ADDRESSES); curr = curr->ai_next) {
+        if (sizeof(struct sockaddr_storage) >= curr->ai_addrlen) {
+            memset(&addrs[count], 0, sizeof(struct sockaddr_storage));
+            memcpy(&addrs[count], curr->ai_addr, curr->ai_addrlen);
+            sizes[count] = curr->ai_addrlen;
+            count++;
+        }
+    }
+    freeaddrinfo(result);
+
+    return count;
+}
+
+/**
+ * @brief Search a hostname in the cache, the entries should be locked
+ * @param resolver Resolver instance
+ * @param hostname Hostname
+ * @param port Port
+ * @return Entry if it is found, NULL otherwise
+ */
+static resolver_entry_t *
+resolver_search(resolver_t *resolver, char *hostname, uint16_t port) {
+
+    /* Parse the entries */
+    for (resolver_entry_t *entry = resolver->first; NULL != entry; entry = entry->next) {
+        if ((port == entry->port) && (!strcmp(hostname, entry->hostname))) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Retrieve the current time (CLOCK_MONOTONIC) in seconds
+ * @return Current time
+ */
+static time_t
+resolver_now(void) {
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec;
+}
@@ -0,0 +1,420 @@
+/**
+ * @file      ring.c
+ * @brief     Shared memory ring carrying frames between processes of the same host
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "ring.h"
+
+/******************************************************************************/
+/* Definitions                                                                */
+/******************************************************************************/
+
+/* Magic value of initialized rings */
+#define RING_MAGIC 0x41584F4E
+
+/* Length of the record marking the end of the ring, the next record is at the beginning */
+#define RING_WRAP UINT32_MAX
+
+/* Size of the record header */
+#define RING_RECORD_HEADER_SIZE 4
+
+/* Size of a record aligned on 8 bytes */
+#define RING_RECORD_SIZE(size) ((RING_RECORD_HEADER_SIZE + (size) + 7) & ~(size_t)7)
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Map a shared memory object
+ * @param name Name of the shared memory object
+ * @param fd File descriptor of the shared memory object, closed by the function
+ * @param size Size of the mapping
+ * @return Ring instance if the function succeeded, NULL otherwise
+ */
+static ring_t *ring_map(char *name, int fd, size_t size);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a ring, an existing ring with the same name is replaced
+ * @param name Name of the shared memory object, starting with '/'
+ * @param size Capacity of the ring, rounded up to a power of two
+ * @return Ring instance if the function succeeded, NULL otherwise
+ */
+ring_t *
+ring_create(char *name, size_t size) {
+
+    assert(NULL != name);
+
+    /* Compute the capacity of the ring */
+    size_t capacity = 4096;
+    while ((capacity < size) && (capacity < UINT32_MAX / 2)) {
+        capacity *= 2;
+    }
+
+    /* Create the shared memory object, the ring of a previous instance is replaced */
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (0 > fd) {
+        /* Unable to create the shared memory object */
+        return NULL;
+    }
+    if (0 > ftruncate(fd, sizeof(ring_header_t) + capacity)) {
+        /* Unable to set the size of the shared memory object */
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+
+    /* Map the ring */
+    ring_t *ring = ring_map(name, fd, sizeof(ring_header_t) + capacity);
+    if (NULL == ring) {
+        /* Unable to map the ring */
+        shm_unlink(name);
+        return NULL;
+    }
+
+    /* Initialize the ring, the magic value is written last so that the peer waits for the initialization */
+    ring->header->size = (uint32_t)capacity;
+    atomic_store(&ring->header->producer, 0);
+    atomic_store(&ring->header->consumer, 0);
+    atomic_store(&ring->header->head, 0);
+    atomic_store(&ring->header->tail, 0);
+    atomic_store(&ring->header->signal, 0);
+    atomic_store(&ring->header->waiting, 0);
+    atomic_store(&ring->header->freed, 0);
+    atomic_store(&ring->header->full, 0);
+    atomic_thread_fence(memory_order_release);
+    ring->header->magic = RING_MAGIC;
+
+    return ring;
+}
+
+/**
+ * @brief Function used to open an existing ring
+ * @param name Name of the shared memory object, starting with '/'
+ * @return Ring instance if the function succeeded, NULL if the ring does not exist or is not initialized yet
+ */
+ring_t *
+ring_open(char *name) {
+
+    assert(NULL != name);
+
+    /* Open the shared memory object and check its size */
+    int fd = shm_open(name, O_RDWR, 0600);
+    if (0 > fd) {
+        /* The ring does not exist */
+        return NULL;
+    }
+    struct stat st;
+    if ((0 > fstat(fd, &st)) || ((size_t)st.st_size <= sizeof(ring_header_t))) {
+        /* The ring is not initialized yet */
+        close(fd);
+        return NULL;
+    }
+
+    /* Map the ring and check it is initialized */
+    ring_t *ring = ring_map(name, fd, (size_t)st.st_size);
+    if (NULL == ring) {
+        /* Unable to map the ring */
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    if ((RING_MAGIC != ring->header->magic) || (sizeof(ring_header_t) + ring->header->size != ring->size)) {
+        /* The ring is not initialized yet */
+        ring_release(ring, false);
+        return NULL;
+    }
+
+    return ring;
+}
+
+/**
+ * @brief Claim the producer or the consumer role of a ring, a ring links a single producer to a single consumer
+ * @param ring Ring instance
+ * @param producer true to claim the producer role, false to claim the consumer role
+ * @return 0 if the function succeeded, -1 if the role is already claimed by another instance
+ */
+int
+ring_claim(ring_t *ring, bool producer) {
+
+    assert(NULL != ring);
+    assert(false == ring->claimed);
+
+    /* Claim the role, it is released when the instance is released */
+    uint32_t expected = 0;
+    if (false == atomic_compare_exchange_strong((true == producer) ? &ring->header->producer : &ring->header->consumer, &expected, 1)) {
+        /* Role already claimed */
+        return -1;
+    }
+    ring->claimed  = true;
+    ring->producer = producer;
+
+    return 0;
+}
+
+/**
+ * @brief Write a record to the ring, the function waits while the ring is full
+ * @param ring Ring instance
+ * @param buffer Data to write
+ * @param size Size of the data
+ * @param timeout Maximum time to wait for free space in milliseconds
+ * @return 0 if the function succeeded, -1 if the data are too large for the ring, if the ring has no consumer or if it is still full after the timeout
+ */
+int
+ring_write(ring_t *ring, void *buffer, size_t size, int timeout) {
+
+    assert(NULL != ring);
+    assert((NULL != buffer) || (0 == size));
+
+    ring_header_t *header = ring->header;
+    size_t         length = RING_RECORD_SIZE(size);
+
+    /* Check the record fits in the ring with the end marker which may be needed */
+    if (length > header->size / 2) {
+        /* Data too large */
+        return -1;
+    }
+
+    /* Check the consumer is present, the records would never be read otherwise */
+    if (0 == atomic_load(&header->consumer)) {
+        /* No consumer */
+        return -1;
+    }
+
+    /* Producers of the process are serialized, the ring has a single producer from the peer point of view */
+    sem_wait(&ring->sem);
+
+    /* Wait for enough free space, including the end of the ring which is skipped if the record does not fit contiguously, as long as the consumer is present and at most timeout milliseconds */
+    uint64_t head = atomic_load_explicit(&header->head, memory_order_relaxed);
+    size_t   pos  = head & (header->size - 1);
+    size_t   skip = (header->size - pos < length) ? header->size - pos : 0;
+    if (header->size - (head - atomic_load_explicit(&header->tail, memory_order_acquire)) < skip + length) {
+        struct timespec start, now;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (header->size - (head - atomic_load_explicit(&header->tail, memory_order_acquire)) < skip + length) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long elapsed = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+            if ((0 == atomic_load(&header->consumer)) || (elapsed >= timeout)) {
+                /* Ring full, the consumer is gone or too slow */
+                sem_post(&ring->sem);
+                return -1;
+            }
+
+            /* Wait for the consumer to read records, it wakes up the producer only if it is waiting */
+            uint32_t freed = atomic_load(&header->freed);
+            atomic_store(&header->full, 1);
+            if (header->size - (head - atomic_load(&header->tail)) < skip + length) {
+                struct timespec ts = { (timeout - elapsed) / 1000, ((timeout - elapsed) % 1000) * 1000000 };
+                syscall(SYS_futex, &header->freed, FUTEX_WAIT, freed, &ts, NULL, 0);
+            }
+            atomic_store(&header->full, 0);
+        }
+    }
+
+    /* Write the end marker if needed, then the record */
+    if (0 < skip) {
+        *(uint32_t *)&header->data[pos] = RING_WRAP;
+        head += skip;
+        pos = 0;
+    }
+    *(uint32_t *)&header->data[pos] = (uint32_t)size;
+    memcpy(&header->data[pos + RING_RECORD_HEADER_SIZE], buffer, size);
+    atomic_store_explicit(&header->head, head + length, memory_order_release);
+
+    /* Release semaphore */
+    sem_post(&ring->sem);
+
+    /* Wake up the consumer if it is waiting */
+    atomic_fetch_add(&header->signal, 1);
+    if (0 != atomic_load(&header->waiting)) {
+        syscall(SYS_futex, &header->signal, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Read the records available in the ring, the function waits if the ring is empty
+ * @param ring Ring instance
+ * @param buffer Data of the records concatenated, to be released by the caller, NULL if there is none
+ * @param size Size of the data
+ * @param timeout Maximum time to wait in milliseconds
+ * @return 0 if the function succeeded, -1 if no record has been read
+ */
+int
+ring_read(ring_t *ring, void **buffer, size_t *size, int timeout) {
+
+    assert(NULL != ring);
+    assert(NULL != buffer);
+    assert(NULL != size);
+
+    ring_header_t *header = ring->header;
+    uint64_t       tail   = atomic_load_explicit(&header->tail, memory_order_relaxed);
+
+    *buffer = NULL;
+    *size   = 0;
+
+    /* Wait for records, the producer wakes up the consumer only if it is waiting */
+    if (tail == atomic_load_explicit(&header->head, memory_order_acquire)) {
+        uint32_t signal = atomic_load(&header->signal);
+        atomic_store(&header->waiting, 1);
+        if (tail == atomic_load(&header->head)) {
+            struct timespec ts = { timeout / 1000, (timeout % 1000) * 1000000 };
+            syscall(SYS_futex, &header->signal, FUTEX_WAIT, signal, &ts, NULL, 0);
+        }
+        atomic_store(&header->waiting, 0);
+    }
+
+    /* Concatenate the records available, at least the first one is read even if it is large */
+    uint64_t head     = atomic_load_explicit(&header->head, memory_order_acquire);
+    size_t   capacity = 0;
+    while ((tail != head) && ((0 == *size) || (*size < RING_READ_SIZE))) {
+        size_t   pos    = tail & (header->size - 1);
+        uint32_t length = *(uint32_t *)&header->data[pos];
+        if (RING_WRAP == length) {
+            /* End marker, the next record is at the beginning of the ring */
+            tail += header->size - pos;
+            continue;
+        }
+        if ((0 < *size) && (*size + length > RING_READ_SIZE)) {
+            /* Read the record next time */
+            break;
+        }
+        if (*size + length > capacity) {
+            capacity     = (*size + length > RING_READ_SIZE) ? *size + length : RING_READ_SIZE;
+            uint8_t *tmp = (uint8_t *)realloc(*buffer, capacity);
+            if (NULL == tmp) {
+                /* Unable to allocate memory, the records already read are given */
+                break;
+            }
+            *buffer = tmp;
+        }
+        memcpy((uint8_t *)*buffer + *size, &header->data[pos + RING_RECORD_HEADER_SIZE], length);
+        *size += length;
+        tail += RING_RECORD_SIZE(length);
+    }
+    atomic_store_explicit(&header->tail, tail, memory_order_release);
+
+    /* Wake up the producer if it is waiting for free space */
+    if (0 < *size) {
+        atomic_fetch_add(&header->freed, 1);
+        if (0 != atomic_load(&header->full)) {
+            syscall(SYS_futex, &header->freed, FUTEX_WAKE, 1, NULL, NULL, 0);
+        }
+    }
+
+    return (0 < *size) ? 0 : -1;
+}
+
+/**
+ * @brief Release ring instance, the role claimed is given up
+ * @param ring Ring instance
+ * @param destroy true to remove the shared memory object, false to keep it for the peer
+ */
+void
+ring_release(ring_t *ring, bool destroy) {
+
+    /* Release ring instance */
+    if (NULL != ring) {
+        if (true == ring->claimed) {
+            atomic_store((true == ring->producer) ? &ring->header->producer : &ring->header->consumer, 0);
+        }
+        if ((true == ring->claimed) && (false == ring->producer)) {
+            /* Wake up the producer waiting for free space, the ring is not read anymore */
+            atomic_fetch_add(&ring->header->freed, 1);
+            syscall(SYS_futex, &ring->header->freed, FUTEX_WAKE, 1, NULL, NULL, 0);
+        }
+        munmap(ring->header, ring->size);
+        if (true == destroy) {
+            shm_unlink(ring->name);
+        }
+        sem_close(&ring->sem);
+        free(ring->name);
+        free(ring);
+    }
+}
+
+/**
+ * @brief Map a shared memory object
+ * @param name Name of the shared memory object
+ * @param fd File descriptor of the shared memory object, closed by the function
+ * @param size Size of the mapping
+ * @return Ring instance if the function succeeded, NULL otherwise
+ */
+static ring_t *
+ring_map(char *name, int fd, size_t size) {
+
+    /* Create ring instance */
+    ring_t *ring = (ring_t *)malloc(sizeof(ring_t));
+    if (NULL == ring) {
+        /* Unable to allocate memory */
+        close(fd);
+        return NULL;
+    }
+    memset(ring, 0, sizeof(ring_t));
+    if (NULL == (ring->name = strdup(name))) {
+        /* Unable to allocate memory */
+        close(fd);
+        free(ring);
+        return NULL;
+    }
+
+    /* Map the shared memory object, the file descriptor is not needed anymore */
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == addr) {
+        /* Unable to map the shared memory object */
+        free(ring->name);
+        free(ring);
+        return NULL;
+    }
+    ring->header = (ring_header_t *)addr;
+    ring->size   = size;
+    sem_init(&ring->sem, 0, 1);
+
+    return ring;
+}
@@ -33,15 +33,25 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdarg.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <poll.h>
 #include <assert.h>
 #include <sys/time.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <sys/un.h>
+#include <sys/stat.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <sched.h>
+#include <signal.h>
 #include <semaphore.h>
 #include <pthread.h>
 
@@ -72,6 +82,12 @@ static void *sock_thread_reader(void *arg);
  */
 static void *sock_thread_messenger(void *arg);
 
+/**
+ * @brief Sock task used to handle data received when an executor is defined
+ * @param arg Worker
+ */
+static void sock_task_messenger(void *arg);
+
 /**
  * @brief Sock thread used to send data
  * @param arg Worker
@@ -79,15 +95,208 @@ static void *sock_thread_messenger(void *arg);
  */
 static void *sock_thread_sender(void *arg);
 
+/**
+ * @brief Sock thread used to open a ring created by the peer and to read the ring if it is not a producer
+ * @param arg Ring
+ * @return Always returns NULL
+ */
+static void *sock_thread_ring(void *arg);
+
+/**
+ * @brief Sock thread used to receive the datagrams of the multicast group
+ * @param arg Sock instance
+ * @return Always returns NULL
+ */
+static void *sock_thread_multicast(void *arg);
+
+/**
+ * @brief Dispatch data received from a ring or a multicast group, there is no socket associated to them
+ * @param sock Sock instance
+ * @param buffer Data received, released by the function if they can't be dispatched
+ * @param size Size of data received
+ */
+static void sock_dispatch_data(sock_t *sock, void *buffer, size_t size);
+
+/**
+ * @brief Send data to the rings
+ * @param sock Sock instance
+ * @param buffer Buffer to be sent, released if it has been sent to all its destinations
+ * @param size Size of buffer to send
+ * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @return 1 if the data have been sent to all their destinations, 0 if they should be sent to the sockets, -1 otherwise, rings unable to receive broadcasted data are reported with the error callback
+ */
+static int sock_ring_send(sock_t *sock, void *buffer, size_t size, int socket);
+
+/**
+ * @brief Write data to a ring opened by the instance
+ * @param ring Ring
+ * @param buffer Buffer to be sent
+ * @param size Size of buffer to send
+ * @param handover true if the buffer is given to the in-process queue instead of being copied, it is then released by the peer
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int sock_ring_write(sock_ring_t *ring, void *buffer, size_t size, bool handover);
+
+/**
+ * @brief Check if a ring has been opened by the instance
+ * @param ring Ring
+ * @return true if the ring is opened, false if it is waiting for the peer to create it
+ */
+static bool sock_ring_opened(sock_ring_t *ring);
+
+/**
+ * @brief Check if data can be written to a ring opened by the instance
+ * @param ring Ring
+ * @return true if the ring is opened and its consumer is present, false otherwise
+ */
+static bool sock_ring_ready(sock_ring_t *ring);
+
+/**
+ * @brief Add a ring to the sock instance
+ * @param sock Sock instance
+ * @param name Name of the shared memory object or of the in-process queue
+ * @param producer true if data are sent to the ring, false if they are received from the ring
+ * @param local true if the ring is an in-process queue, false if it is a shared memory ring
+ * @param ring Shared memory ring if it is created by the instance, NULL otherwise
+ * @param queue In-process queue if it is created by the instance, NULL otherwise
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int sock_add_ring(sock_t *sock, char *name, bool producer, bool local, ring_t *ring, inproc_t *queue);
+
+/**
+ * @brief Sock thread used to flush the batches when their deadline is reached
+ * @param arg Sock instance
+ * @return Always returns NULL
+ */
+static void *sock_thread_flusher(void *arg);
+
+/**
+ * @brief Start a new sender
+ * @param sock Sock instance
+ * @param buffer Buffer to be sent, released once it is sent
+ * @param size Size of buffer to send
+ * @param files Parts of files sent within the buffer, released once they are sent, NULL if there is none
+ * @param count Amount of parts of files
+ * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int sock_start_sender(sock_t *sock, void *buffer, size_t size, sock_file_t *files, size_t count, int socket);
+
+/**
+ * @brief Add data to the batch of their destination, the batch is flushed if it is full
+ * @param sock Sock instance
+ * @param buffer Buffer to be sent, released once it is copied
+ * @param size Size of buffer to send
+ * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @return 0 if the function succeeded or if the data have been copied to the batch, -1 if the buffer has not been released
+ */
+static int sock_batch_add(sock_t *sock, void *buffer, size_t size, int socket);
+
+/**
+ * @brief Flush a batch, it is removed from the batches and released, batches semaphore must be held
+ * @param sock Sock instance
+ * @param batch Batch to flush
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int sock_batch_flush(sock_t *sock, sock_batch_t *batch);
+
+/**
+ * @brief Report the data of a batch dropped because it can't be sent, batches semaphore must be released so that the callback may use the instance
+ * @param sock Sock instance
+ */
+static void sock_batch_dropped(sock_t *sock);
+
+/**
+ * @brief Dispatch data received to a new messenger, to the executor or inline in spin or inline mode
+ * @param sock Sock instance
+ * @param worker Messenger holding the data received
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int sock_dispatch(sock_t *sock, sock_worker_t *worker);
+
+/**
+ * @brief Retrieve the CPU which received the last packets of a socket
+ * @param sock Sock instance
+ * @param socket Socket
+ * @return CPU index, -1 if it is unknown or if the option is disabled
+ */
+static int sock_incoming_cpu(sock_t *sock, int socket);
+
+/**
+ * @brief Apply the TCP options to an accepted or connected socket
+ * @param sock Sock instance
+ * @param socket Socket
+ * @param tcp true if the socket is a TCP socket, false if it is a Unix domain socket to which only the buffer sizes and busy polling apply
+ * @return 0 if the function succeeded, -1 if at least one option could not be set
+ */
+static int sock_setup(sock_t *sock, int socket, bool tcp);
+
+/**
+ * @brief Send data of a sender to a socket, without copy if they are large enough
+ * @param sock Sock instance
+ * @param socket Socket
+ * @param worker Sender, its buffer is kept until the completions of the zero-copy sends are read
+ * @param buffer Data to be sent, part of the buffer of the sender
+ * @param size Size of data to send
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int sock_write(sock_t *sock, int socket, sock_worker_t *worker, void *buffer, size_t size);
+
+/**
+ * @brief Send the data and the files of a sender to a socket
+ * @param sock Sock instance
+ * @param socket Socket
+ * @param worker Sender
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int sock_transmit(sock_t *sock, int socket, sock_worker_t *worker);
+
+/**
+ * @brief Read the zero-copy completions of a socket without data to read, the data whose sends are completed are released
+ * @param sock Sock instance
+ * @param socket Socket
+ * @return true if the socket is still connected, false if it should be closed
+ */
+static bool sock_completions_read(sock_t *sock, int socket);
+
+/**
+ * @brief Release the data sent without copy to a socket which is closed
+ * @param sock Sock instance
+ * @param socket Socket
+ */
+static void sock_completions_drop(sock_t *sock, int socket);
+
+/**
+ * @brief Release the data in flight of a socket whose sends are completed, the semaphore of the zero-copy sends is held by the caller
+ * @param sock Sock instance
+ * @param socket Socket
+ * @param all true to release all the data in flight of the socket, false to release only the completed ones
+ */
+static void sock_completions_release(sock_t *sock, int socket, bool all);
+
+/**
+ * @brief Release a reference to the buffer of a sender, the semaphore of the zero-copy sends is held by the caller
+ * @param hold Buffer of the sender
+ */
+static void sock_hold_release(sock_hold_t *hold);
+
+/**
+ * @brief Release the buffer of a sender, it is kept until the completions of its zero-copy sends have been read
+ * @param sock Sock instance
+ * @param worker Sender
+ */
+static void sock_sender_release(sock_t *sock, sock_worker_t *worker);
+
 /**
  * @brief Start a new worker
  * @param sock Sock instance
  * @param list List of workers to which the new one should be added
  * @param worker Worker to start
  * @param start_routine Worker thread function
+ * @param cpus CPUs on which the worker is running, NULL or empty set if it is not pinned
  * @return 0 if the function succeeded, -1 otherwise
  */
-static int sock_start_worker(sock_t *sock, sock_worker_list_t *list, sock_worker_t *worker, void *(*start_routine)(void *));
+static int sock_start_worker(sock_t *sock, sock_worker_list_t *list, sock_worker_t *worker, void *(*start_routine)(void *), cpu_set_t *cpus);
 
 /**
  * @brief Remove a worker
@@ -98,6 +307,12 @@ static int sock_start_worker(sock_t *sock, sock_worker_list_t *list, sock_worker
  */
 static int sock_remove_worker(sock_t *sock, sock_worker_list_t *list, sock_worker_t *worker);
 
+/**
+ * @brief Remove the file of a Unix domain socket, any other kind of file at this path is kept
+ * @param path Path of the socket
+ */
+static void sock_ipc_unlink(char *path);
+
 /******************************************************************************/
 /* Functions                                                                  */
 /******************************************************************************/
@@ -117,6 +332,13 @@ sock_create(void) {
     }
     memset(sock, 0, sizeof(sock_t));
 
+    /* Create the resolver of the hostnames */
+    if (NULL == (sock->resolver = resolver_create())) {
+        /* Unable to create the resolver */
+        free(sock);
+        return NULL;
+    }
+
     /* Initialize semaphore used to access listenners */
     sem_init(&sock->listenners.sem, 0, 1);
 
@@ -129,10 +351,36 @@ sock_create(void) {
     /* Initialize semaphore used to access senders */
     sem_init(&sock->senders.sem, 0, 1);
 
+    /* Initialize semaphore used to serialize zero-copy sends */
+    sem_init(&sock->zerocopy.sem, 0, 1);
+    FD_ZERO(&sock->zerocopy.fds);
+
+    /* Initialize semaphore used to access rings */
+    sem_init(&sock->rings.sem, 0, 1);
+    sock->options.ring.size    = RING_SIZE;
+    sock->options.ring.timeout = RING_TIMEOUT;
+
+    /* Multicast datagrams stay on the local network and are received by the subscribers of the host by default */
+    sock->options.multicast.ttl  = 1;
+    sock->options.multicast.loop = true;
+    sock->options.multicast.size = MCAST_SIZE;
+
     /* Initialize clients FDs and semaphore */
     sem_init(&sock->clients.sem, 0, 1);
     FD_ZERO(&sock->clients.fds);
 
+    /* Initialize batches semaphores, micro-batching is disabled by default */
+    sem_init(&sock->batches.sem, 0, 1);
+    sem_init(&sock->batches.signal, 0, 0);
+    sock->options.batch.size = SOCK_BATCH_SIZE;
+
+    /* Nagle algorithm is disabled by default, the other TCP options keep the system defaults */
+    sock->options.tcp.nodelay = true;
+
+    /* Threads are not pinned by default */
+    CPU_ZERO(&sock->options.affinity.reader);
+    CPU_ZERO(&sock->options.affinity.worker);
+
     return sock;
 }
 
@@ -160,7 +408,7 @@ sock_bind(sock_t *sock, uint16_t port) {
     FD_ZERO(&worker->type.listenner.fds);
 
     /* Start listenner */
-    if (0 != sock_start_worker(sock, &sock->listenners, worker, sock_thread_listenner)) {
+    if (0 != sock_start_worker(sock, &sock->listenners, worker, sock_thread_listenner, &sock->options.affinity.reader)) {
         /* Unable to start the worker */
         free(worker);
         return -1;
@@ -172,7 +420,7 @@ sock_bind(sock_t *sock, uint16_t port) {
 /**
  * @brief Connect a new socket to the wanted host and port
  * @param sock Sock instance
- * @param hostname Hostname
+ * @param hostname Hostname, IPv4 or IPv6 address
  * @param port Port
  * @return 0 if the function succeeded, -1 otherwise
  */
@@ -199,7 +447,7 @@ sock_connect(sock_t *sock, char *hostname, uint16_t port) {
     FD_ZERO(&worker->type.reader.fds);
 
     /* Start reader */
-    if (0 != sock_start_worker(sock, &sock->readers, worker, sock_thread_reader)) {
+    if (0 != sock_start_worker(sock, &sock->readers, worker, sock_thread_reader, &sock->options.affinity.reader)) {
         /* Unable to start the worker */
         free(worker->type.reader.hostname);
         free(worker);
@@ -210,95 +458,125 @@ sock_connect(sock_t *sock, char *hostname, uint16_t port) {
 }
 
 /**
- * @brief Check if sock is already connected to the wanted host and port
+ * @brief Bind a new Unix domain socket to the wanted path
  * @param sock Sock instance
- * @param hostname Hostname
- * @param port Port
- * @return true if already connected, false otherwise
+ * @param path Path of the socket, shorter than the path of a Unix domain socket address, an existing socket file is removed
+ * @return 0 if the function succeeded, -1 otherwise
  */
-bool
-sock_is_connected(sock_t *sock, char *hostname, uint16_t port) {
+int
+sock_bind_ipc(sock_t *sock, char *path) {
 
     assert(NULL != sock);
-    assert(NULL != hostname);
+    assert(NULL != path);
 
-    bool ret = false;
+    /* The path must fit in the address of the socket, it is not truncated */
+    if (sizeof(((struct sockaddr_un *)NULL)->sun_path) <= strlen(path)) {
+        /* Path too long */
+        return -1;
+    }
 
-    /* Parse readers */
-    sem_wait(&sock->readers.sem);
-    sock_worker_t *worker = sock->readers.first;
-    while (NULL != worker) {
-        if ((!strcmp(hostname, worker->type.reader.hostname)) && (port == worker->type.reader.port)) {
-            ret = true;
-            break;
-        }
-        worker = worker->next;
+    /* Create new listenner */
+    sock_worker_t *worker = (sock_worker_t *)malloc(sizeof(sock_worker_t));
+    if (NULL == worker) {
+        /* Unable to allocate memory */
+        return -1;
     }
-    sem_post(&sock->readers.sem);
+    memset(worker, 0, sizeof(sock_worker_t));
 
-    return ret;
+    /* Store path, initialize FDs */
+    if (NULL == (worker->type.listenner.path = strdup(path))) {
+        /* Unable to allocate memory */
+        free(worker);
+        return -1;
+    }
+    FD_ZERO(&worker->type.listenner.fds);
+
+    /* Start listenner */
+    if (0 != sock_start_worker(sock, &sock->listenners, worker, sock_thread_listenner, &sock->options.affinity.reader)) {
+        /* Unable to start the worker */
+        free(worker->type.listenner.path);
+        free(worker);
+        return -1;
+    }
+
+    return 0;
 }
 
 /**
- * @brief Register callbacks
+ * @brief Connect a new Unix domain socket to the wanted path
  * @param sock Sock instance
- * @param topic Topic
- * @param fct Callback function
- * @param user User data
+ * @param path Path of the socket, shorter than the path of a Unix domain socket address
  * @return 0 if the function succeeded, -1 otherwise
  */
 int
-sock_on(sock_t *sock, char *topic, void *fct, void *user) {
+sock_connect_ipc(sock_t *sock, char *path) {
 
     assert(NULL != sock);
-    assert(NULL != topic);
+    assert(NULL != path);
 
-    /* Record callback depending of the topic */
-    if (!strcmp(topic, "bind")) {
-        sock->cb.bind.fct  = fct;
-        sock->cb.bind.user = user;
-    } else if (!strcmp(topic, "message")) {
-        sock->cb.message.fct  = fct;
-        sock->cb.message.user = user;
-    } else if (!strcmp(topic, "error")) {
-        sock->cb.error.fct  = fct;
-        sock->cb.error.user = user;
+    /* The path must fit in the address of the socket, it is not truncated */
+    if (sizeof(((struct sockaddr_un *)NULL)->sun_path) <= strlen(path)) {
+        /* Path too long */
+        return -1;
+    }
+
+    /* Create new reader */
+    sock_worker_t *worker = (sock_worker_t *)malloc(sizeof(sock_worker_t));
+    if (NULL == worker) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    memset(worker, 0, sizeof(sock_worker_t));
+
+    /* Store path, initialize FDs */
+    if (NULL == (worker->type.reader.hostname = strdup(path))) {
+        /* Unable to allocate memory */
+        free(worker);
+        return -1;
+    }
+    worker->type.reader.ipc = true;
+    FD_ZERO(&worker->type.reader.fds);
+
+    /* Start reader */
+    if (0 != sock_start_worker(sock, &sock->readers, worker, sock_thread_reader, &sock->options.affinity.reader)) {
+        /* Unable to start the worker */
+        free(worker->type.reader.hostname);
+        free(worker);
+        return -1;
     }
 
     return 0;
 }
 
 /**
- * @brief Function used to send data
+ * @brief Create a new shared memory ring linking the instance to a peer of the same host
  * @param sock Sock instance
- * @param buffer Buffer to be sent
- * @param size Size of buffer to send
- * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @param name Name of the shared memory object, starting with '/', an existing ring is replaced
+ * @param producer true if data are sent to the ring, false if they are received from the ring
  * @return 0 if the function succeeded, -1 otherwise
  */
 int
-sock_send(sock_t *sock, void *buffer, size_t size, int socket) {
+sock_bind_ring(sock_t *sock, char *name, bool producer) {
 
     assert(NULL != sock);
-    assert(NULL != buffer);
+    assert(NULL != name);
 
-    /* Create new sender */
-    sock_worker_t *worker = (sock_worker_t *)malloc(sizeof(sock_worker_t));
-    if (NULL == worker) {
-        /* Unable to allocate memory */
+    /* Create the ring and claim the role of the instance, the ring is new so that it can't be already claimed */
+    ring_t *ring = ring_create(name, sock->options.ring.size);
+    if (NULL == ring) {
+        /* Unable to create the ring */
+        return -1;
+    }
+    if (0 != ring_claim(ring, producer)) {
+        /* Unable to claim the ring */
+        ring_release(ring, true);
         return -1;
     }
-    memset(worker, 0, sizeof(sock_worker_t));
-
-    /* Store buffer, size and socket */
-    worker->type.sender.buffer = buffer;
-    worker->type.sender.size   = size;
-    worker->type.sender.socket = socket;
 
-    /* Start sender */
-    if (0 != sock_start_worker(sock, &sock->senders, worker, sock_thread_sender)) {
-        /* Unable to start the worker */
-        free(worker);
+    /* Add the ring */
+    if (0 != sock_add_ring(sock, name, producer, false, ring, NULL)) {
+        /* Unable to add the ring */
+        ring_release(ring, true);
         return -1;
     }
 
@@ -306,42 +584,455 @@ sock_send(sock_t *sock, void *buffer, size_t size, int socket) {
 }
 
 /**
- * @brief Release sock instance
+ * @brief Open a shared memory ring created by a peer of the same host, the ring is opened as soon as it is created
  * @param sock Sock instance
+ * @param name Name of the shared memory object, starting with '/'
+ * @param producer true if data are sent to the ring, false if they are received from the ring
+ * @return 0 if the function succeeded, -1 otherwise
  */
-void
-sock_release(sock_t *sock) {
+int
+sock_connect_ring(sock_t *sock, char *name, bool producer) {
 
-    /* Release sock instance */
-    if (NULL != sock) {
+    assert(NULL != sock);
+    assert(NULL != name);
 
-        /* Release listenners */
-        sem_wait(&sock->listenners.sem);
-        sock_worker_t *worker = sock->listenners.first;
-        while (NULL != worker) {
-            sock_worker_t *tmp = worker;
-            worker             = worker->next;
-            pthread_cancel(tmp->thread);
-            pthread_join(tmp->thread, NULL);
-            for (int index = 0; index < FD_SETSIZE; index++) {
-                if (FD_ISSET(index, &tmp->type.listenner.fds)) {
-                    close(index);
-                }
-            }
-            free(tmp);
-        }
-        sem_post(&sock->listenners.sem);
-        sem_close(&sock->listenners.sem);
+    return sock_add_ring(sock, name, producer, false, NULL, NULL);
+}
 
-        /* Release readers */
-        sem_wait(&sock->readers.sem);
-        worker = sock->readers.first;
-        while (NULL != worker) {
-            sock_worker_t *tmp = worker;
-            worker             = worker->next;
-            pthread_cancel(tmp->thread);
-            pthread_join(tmp->thread, NULL);
-            for (int index = 0; index < FD_SETSIZE; index++) {
+/**
+ * @brief Create a new in-process queue linking the instance to a peer of the same process
+ * @param sock Sock instance
+ * @param name Name of the queue, unique in the process
+ * @param producer true if data are sent to the queue, false if they are received from the queue
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+sock_bind_inproc(sock_t *sock, char *name, bool producer) {
+
+    assert(NULL != sock);
+    assert(NULL != name);
+
+    /* Create the queue */
+    inproc_t *queue = inproc_create(name);
+    if (NULL == queue) {
+        /* Unable to create the queue */
+        return -1;
+    }
+
+    /* Add the queue, the instance is its consumer if it does not send data */
+    atomic_store(&queue->consumer, !producer);
+    if (0 != sock_add_ring(sock, name, producer, true, NULL, queue)) {
+        /* Unable to add the queue */
+        inproc_release(queue, true);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Open an in-process queue created by a peer of the same process, the queue is opened as soon as it is created
+ * @param sock Sock instance
+ * @param name Name of the queue
+ * @param producer true if data are sent to the queue, false if they are received from the queue
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+sock_connect_inproc(sock_t *sock, char *name, bool producer) {
+
+    assert(NULL != sock);
+    assert(NULL != name);
+
+    return sock_add_ring(sock, name, producer, true, NULL, NULL);
+}
+
+/**
+ * @brief Bind the instance to a UDP multicast group, data broadcasted are sent to the group once whatever the amount of receivers
+ * @param sock Sock instance
+ * @param group IPv4 address of the multicast group
+ * @param port Port of the group
+ * @param producer true if data are sent to the group, false if they are received from the group
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+sock_bind_multicast(sock_t *sock, char *group, uint16_t port, bool producer) {
+
+    assert(NULL != sock);
+    assert(NULL != group);
+
+    /* The instance is bound to a single group */
+    if (NULL != sock->multicast.mcast) {
+        /* Already bound */
+        return -1;
+    }
+
+    /* Create the multicast instance */
+    mcast_t *mcast = (true == producer) ? mcast_create_sender(group, port, sock->options.multicast.interface, sock->options.multicast.ttl,
+                                                              sock->options.multicast.loop, sock->options.multicast.size)
+                                        : mcast_create_receiver(group, port, sock->options.multicast.interface);
+    if (NULL == mcast) {
+        /* Unable to create the multicast instance */
+        return -1;
+    }
+
+    /* Start the thread receiving the datagrams */
+    sock->multicast.mcast = mcast;
+    atomic_store(&sock->multicast.stop, false);
+    if ((false == producer) && (0 != pthread_create(&sock->multicast.thread, NULL, sock_thread_multicast, sock))) {
+        /* Unable to start the thread */
+        sock->multicast.mcast = NULL;
+        mcast_release(mcast);
+        return -1;
+    }
+    sock->multicast.started = !producer;
+
+    return 0;
+}
+
+/**
+ * @brief Check if sock is already connected to the wanted host and port
+ * @param sock Sock instance
+ * @param hostname Hostname
+ * @param port Port
+ * @return true if already connected, false otherwise
+ */
+bool
+sock_is_connected(sock_t *sock, char *hostname, uint16_t port) {
+
+    assert(NULL != sock);
+    assert(NULL != hostname);
+
+    bool ret = false;
+
+    /* Parse readers */
+    sem_wait(&sock->readers.sem);
+    sock_worker_t *worker = sock->readers.first;
+    while (NULL != worker) {
+        if ((!strcmp(hostname, worker->type.reader.hostname)) && (port == worker->type.reader.port)) {
+            ret = true;
+            break;
+        }
+        worker = worker->next;
+    }
+    sem_post(&sock->readers.sem);
+
+    return ret;
+}
+
+/**
+ * @brief Register callbacks
+ * @param sock Sock instance
+ * @param topic Topic
+ * @param fct Callback function
+ * @param user User data
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+sock_on(sock_t *sock, char *topic, void *fct, void *user) {
+
+    assert(NULL != sock);
+    assert(NULL != topic);
+
+    /* Record callback depending of the topic */
+    if (!strcmp(topic, "bind")) {
+        sock->cb.bind.fct  = fct;
+        sock->cb.bind.user = user;
+    } else if (!strcmp(topic, "message")) {
+        sock->cb.message.fct  = fct;
+        sock->cb.message.user = user;
+    } else if (!strcmp(topic, "error")) {
+        sock->cb.error.fct  = fct;
+        sock->cb.error.user = user;
+    } else if (!strcmp(topic, "close")) {
+        sock->cb.close.fct  = fct;
+        sock->cb.close.user = user;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Set option
+ * @param sock Sock instance
+ * @param name Option name
+ * @param params Option value
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+sock_vset(sock_t *sock, char *name, va_list params) {
+
+    assert(NULL != sock);
+    assert(NULL != name);
+
+    /* Record option depending of the name */
+    if (!strcmp(name, "workers")) {
+        int count = va_arg(params, int);
+        if (NULL != sock->executor) {
+            /* Executor already started */
+            return -1;
+        }
+        if ((0 < count) && (NULL == (sock->executor = executor_create(count)))) {
+            /* Unable to create the executor */
+            return -1;
+        }
+        if ((NULL != sock->executor) && (0 < CPU_COUNT(&sock->options.affinity.worker))) {
+            executor_set_affinity(sock->executor, &sock->options.affinity.worker);
+        }
+    } else if (!strcmp(name, "ordered")) {
+        sock->options.ordered = (0 != va_arg(params, int));
+    } else if (!strcmp(name, "spin")) {
+        sock->options.spin = (0 != va_arg(params, int));
+    } else if (!strcmp(name, "zero copy size")) {
+        int size               = va_arg(params, int);
+        sock->options.zerocopy = (0 < size) ? (size_t)size : 0;
+    } else if (!strcmp(name, "ring size")) {
+        int size                = va_arg(params, int);
+        sock->options.ring.size = (0 < size) ? (size_t)size : RING_SIZE;
+    } else if (!strcmp(name, "ring timeout")) {
+        int timeout                = va_arg(params, int);
+        sock->options.ring.timeout = (0 < timeout) ? timeout : 0;
+    } else if (!strcmp(name, "multicast ttl")) {
+        sock->options.multicast.ttl = va_arg(params, int);
+    } else if (!strcmp(name, "multicast loop")) {
+        sock->options.multicast.loop = (0 != va_arg(params, int));
+    } else if (!strcmp(name, "multicast size")) {
+        int size                     = va_arg(params, int);
+        sock->options.multicast.size = (0 < size) ? (size_t)size : MCAST_SIZE;
+    } else if (!strcmp(name, "multicast interface")) {
+        char *interface = va_arg(params, char *);
+        free(sock->options.multicast.interface);
+        sock->options.multicast.interface = NULL;
+        if ((NULL != interface) && (NULL == (sock->options.multicast.interface = strdup(interface)))) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+    } else if (!strcmp(name, "resolver refresh")) {
+        int refresh = va_arg(params, int);
+        resolver_set_refresh(sock->resolver, (0 < refresh) ? (unsigned int)refresh : 0);
+    } else if (!strcmp(name, "inline")) {
+        sock->options.direct = (0 != va_arg(params, int));
+    } else if (!strcmp(name, "reader affinity")) {
+        cpu_set_t *cpus = va_arg(params, cpu_set_t *);
+        if (NULL == cpus) {
+            CPU_ZERO(&sock->options.affinity.reader);
+        } else {
+            memcpy(&sock->options.affinity.reader, cpus, sizeof(cpu_set_t));
+        }
+    } else if (!strcmp(name, "worker affinity")) {
+        cpu_set_t *cpus = va_arg(params, cpu_set_t *);
+        if (NULL == cpus) {
+            CPU_ZERO(&sock->options.affinity.worker);
+        } else {
+            memcpy(&sock->options.affinity.worker, cpus, sizeof(cpu_set_t));
+        }
+        if ((NULL != sock->executor) && (0 != executor_set_affinity(sock->executor, &sock->options.affinity.worker))) {
+            /* Unable to pin the executor workers */
+            return -1;
+        }
+    } else if (!strcmp(name, "incoming cpu")) {
+        sock->options.affinity.incoming = (0 != va_arg(params, int));
+    } else if (!strcmp(name, "no delay")) {
+        sock->options.tcp.nodelay = (0 != va_arg(params, int));
+    } else if (!strcmp(name, "send buffer")) {
+        sock->options.tcp.sndbuf = va_arg(params, int);
+    } else if (!strcmp(name, "receive buffer")) {
+        sock->options.tcp.rcvbuf = va_arg(params, int);
+    } else if (!strcmp(name, "user timeout")) {
+        sock->options.tcp.user_timeout = va_arg(params, int);
+    } else if (!strcmp(name, "busy poll")) {
+        sock->options.tcp.busy_poll = va_arg(params, int);
+    } else if (!strcmp(name, "keepalive idle")) {
+        sock->options.tcp.keepalive.idle = va_arg(params, int);
+    } else if (!strcmp(name, "keepalive interval")) {
+        sock->options.tcp.keepalive.interval = va_arg(params, int);
+    } else if (!strcmp(name, "keepalive count")) {
+        sock->options.tcp.keepalive.count = va_arg(params, int);
+    } else if (!strcmp(name, "batch delay")) {
+        int delay                 = va_arg(params, int);
+        sock->options.batch.delay = (0 < delay) ? (unsigned int)delay : 0;
+    } else if (!strcmp(name, "batch size")) {
+        int size                 = va_arg(params, int);
+        sock->options.batch.size = (0 < size) ? (size_t)size : SOCK_BATCH_SIZE;
+    } else {
+        /* Unknown option */
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Function used to send data
+ * @param sock Sock instance
+ * @param buffer Buffer to be sent
+ * @param size Size of buffer to send
+ * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+sock_send(sock_t *sock, void *buffer, size_t size, int socket) {
+
+    assert(NULL != sock);
+    assert(NULL != buffer);
+
+    /* Send the broadcasted data to the multicast group first, it may be the only destination, a failure does not prevent sending the data to the other destinations */
+    if ((NULL != sock->multicast.mcast) && (true == sock->multicast.mcast->sender) && (SOCK_SEND_BROADCAST == socket)) {
+        if ((0 != mcast_send(sock->multicast.mcast, buffer, size)) && (NULL != sock->cb.error.fct)) {
+            sock->cb.error.fct(sock, "sock: unable to send data to the multicast group, data too large or dropped", sock->cb.error.user);
+        }
+        if (0 == sock_count(sock)) {
+            /* There is no other destination */
+            free(buffer);
+            return 0;
+        }
+    }
+
+    /* Send the data to the rings first, they may be the only destinations */
+    if (NULL != sock->rings.first) {
+        int ret = sock_ring_send(sock, buffer, size, socket);
+        if (0 != ret) {
+            return (0 < ret) ? 0 : -1;
+        }
+    }
+
+    /* Hold the data with the other data sent to the same destination if micro-batching is enabled */
+    if (0 < sock->options.batch.delay) {
+        return sock_batch_add(sock, buffer, size, socket);
+    }
+
+    /* Start sender */
+    return sock_start_sender(sock, buffer, size, NULL, 0, socket);
+}
+
+/**
+ * @brief Function used to send data with parts of files sent from the kernel without being read (sendfile)
+ * @param sock Sock instance
+ * @param buffer Buffer to be sent
+ * @param size Size of buffer to send
+ * @param files Parts of files sent within the buffer, ordered by position, the array and the file descriptors are released once they are sent
+ * @param count Amount of parts of files
+ * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @return 0 if the function succeeded, -1 otherwise, the buffer and the files are not released in this case
+ */
+int
+sock_send_files(sock_t *sock, void *buffer, size_t size, sock_file_t *files, size_t count, int socket) {
+
+    assert(NULL != sock);
+    assert(NULL != buffer);
+    assert((NULL != files) || (0 == count));
+
+    /* Data without files are sent as usual */
+    if (0 == count) {
+        return sock_send(sock, buffer, size, socket);
+    }
+
+    /* Files are never held, the data already held for the same destination are sent first to keep them in order */
+    if (0 < sock->options.batch.delay) {
+        sem_wait(&sock->batches.sem);
+        sock_batch_t *batch = sock->batches.first;
+        while ((NULL != batch) && (socket != batch->socket)) {
+            batch = batch->next;
+        }
+        bool dropped = ((NULL != batch) && (0 != sock_batch_flush(sock, batch)));
+        sem_post(&sock->batches.sem);
+        if (true == dropped) {
+            sock_batch_dropped(sock);
+        }
+    }
+
+    /* Start sender */
+    return sock_start_sender(sock, buffer, size, files, count, socket);
+}
+
+/**
+ * @brief Retrieve the amount of connected clients and servers
+ * @param sock Sock instance
+ * @return Amount of connected sockets and opened producer rings whose consumer is present
+ */
+int
+sock_count(sock_t *sock) {
+
+    assert(NULL != sock);
+
+    int count = 0;
+
+    /* Parse clients */
+    sem_wait(&sock->clients.sem);
+    for (int index = 0; index < FD_SETSIZE; index++) {
+        if (FD_ISSET(index, &sock->clients.fds)) {
+            count++;
+        }
+    }
+    sem_post(&sock->clients.sem);
+
+    /* Parse rings */
+    sem_wait(&sock->rings.sem);
+    for (sock_ring_t *ring = sock->rings.first; NULL != ring; ring = ring->next) {
+        if ((true == ring->producer) && (true == sock_ring_ready(ring))) {
+            count++;
+        }
+    }
+    sem_post(&sock->rings.sem);
+
+    return count;
+}
+
+/**
+ * @brief Release sock instance
+ * @param sock Sock instance
+ */
+void
+sock_release(sock_t *sock) {
+
+    /* Release sock instance */
+    if (NULL != sock) {
+
+        /* Release flusher and batches first, the flusher sends data using the workers, data which have not been flushed are dropped */
+        if (true == sock->batches.started) {
+            pthread_cancel(sock->batches.thread);
+            pthread_join(sock->batches.thread, NULL);
+        }
+        sock_batch_t *batch = sock->batches.first;
+        while (NULL != batch) {
+            sock_batch_t *tmp = batch;
+            batch             = batch->next;
+            free(tmp->buffer);
+            free(tmp);
+        }
+        sem_close(&sock->batches.signal);
+        sem_close(&sock->batches.sem);
+
+        /* Release listenners */
+        sem_wait(&sock->listenners.sem);
+        sock_worker_t *worker = sock->listenners.first;
+        while (NULL != worker) {
+            sock_worker_t *tmp = worker;
+            worker             = worker->next;
+            pthread_cancel(tmp->thread);
+            pthread_join(tmp->thread, NULL);
+            for (int index = 0; index < FD_SETSIZE; index++) {
+                if (FD_ISSET(index, &tmp->type.listenner.fds)) {
+                    close(index);
+                }
+            }
+            if (NULL != tmp->type.listenner.path) {
+                sock_ipc_unlink(tmp->type.listenner.path);
+                free(tmp->type.listenner.path);
+            }
+            free(tmp);
+        }
+        sem_post(&sock->listenners.sem);
+        sem_close(&sock->listenners.sem);
+
+        /* Release readers */
+        sem_wait(&sock->readers.sem);
+        worker = sock->readers.first;
+        while (NULL != worker) {
+            sock_worker_t *tmp = worker;
+            worker             = worker->next;
+            pthread_cancel(tmp->thread);
+            pthread_join(tmp->thread, NULL);
+            for (int index = 0; index < FD_SETSIZE; index++) {
                 if (FD_ISSET(index, &tmp->type.reader.fds)) {
                     close(index);
                 }
@@ -352,6 +1043,40 @@ sock_release(sock_t *sock) {
         sem_post(&sock->readers.sem);
         sem_close(&sock->readers.sem);
 
+        /* Release resolver */
+        resolver_release(sock->resolver);
+
+        /* Release rings, the rings created by the instance are removed */
+        sock_ring_t *ring = sock->rings.first;
+        while (NULL != ring) {
+            sock_ring_t *tmp = ring;
+            ring             = ring->next;
+            if (true == tmp->started) {
+                atomic_store(&tmp->stop, true);
+                pthread_join(tmp->thread, NULL);
+            }
+            ring_release(atomic_load(&tmp->ring), tmp->owner);
+            if ((false == tmp->producer) && (NULL != atomic_load(&tmp->queue))) {
+                /* The queue is not read anymore, the producers which still have it stop writing to it */
+                atomic_store(&atomic_load(&tmp->queue)->consumer, false);
+            }
+            inproc_release(atomic_load(&tmp->queue), tmp->owner);
+            free(tmp->name);
+            free(tmp);
+        }
+        sem_close(&sock->rings.sem);
+
+        /* Release multicast group */
+        if (true == sock->multicast.started) {
+            atomic_store(&sock->multicast.stop, true);
+            pthread_join(sock->multicast.thread, NULL);
+        }
+        mcast_release(sock->multicast.mcast);
+        free(sock->options.multicast.interface);
+
+        /* Release executor */
+        executor_release(sock->executor);
+
         /* Release messengers */
         sem_wait(&sock->messengers.sem);
         worker = sock->messengers.first;
@@ -374,13 +1099,27 @@ sock_release(sock_t *sock) {
             worker             = worker->next;
             pthread_cancel(tmp->thread);
             pthread_join(tmp->thread, NULL);
-            free(tmp->type.sender.buffer);
+            for (size_t index = 0; index < tmp->type.sender.count; index++) {
+                close(tmp->type.sender.files[index].fd);
+            }
+            free(tmp->type.sender.files);
+            sock_sender_release(sock, tmp);
             free(tmp);
         }
         sem_post(&sock->senders.sem);
         sem_close(&sock->senders.sem);
 
-        /* Release clients semaphore */
+        /* Release zero-copy data in flight, the sockets are closed */
+        sock_zerocopy_t *z = sock->zerocopy.first;
+        while (NULL != z) {
+            sock_zerocopy_t *tmp = z;
+            z                    = z->next;
+            sock_hold_release(tmp->hold);
+            free(tmp);
+        }
+
+        /* Release zero-copy and clients semaphores */
+        sem_close(&sock->zerocopy.sem);
         sem_close(&sock->clients.sem);
 
         /* Release sock instance */
@@ -402,8 +1141,22 @@ sock_thread_listenner(void *arg) {
     sock_worker_t *worker = (sock_worker_t *)arg;
     sock_t *       sock   = worker->parent;
 
-    /* Create new SOCK_STREAM socket */
-    worker->type.listenner.socket = socket(AF_INET, SOCK_STREAM, 0);
+    /* Set thread name */
+    char name[16];
+    if (NULL != worker->type.listenner.path) {
+        snprintf(name, sizeof(name), "axon-bind:ipc");
+    } else {
+        snprintf(name, sizeof(name), "axon-bind:%u", worker->type.listenner.port);
+    }
+    pthread_setname_np(pthread_self(), name);
+
+    /* Create new SOCK_STREAM socket, TCP listenners accept both IPv6 and IPv4 clients unless IPv6 is not supported */
+    int family                    = (NULL != worker->type.listenner.path) ? AF_UNIX : AF_INET6;
+    worker->type.listenner.socket = socket(family, SOCK_STREAM, 0);
+    if ((0 > worker->type.listenner.socket) && (AF_INET6 == family)) {
+        family                        = AF_INET;
+        worker->type.listenner.socket = socket(family, SOCK_STREAM, 0);
+    }
     if (0 > worker->type.listenner.socket) {
         /* Unable to create socket */
         if (NULL != sock->cb.error.fct) {
@@ -425,28 +1178,57 @@ sock_thread_listenner(void *arg) {
         }
         goto END;
     }
-
-    /* Bind socket */
-    struct sockaddr_in addr;
-    addr.sin_family      = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port        = htons(worker->type.listenner.port);
-    if (0 > bind(worker->type.listenner.socket, (struct sockaddr *)&addr, sizeof(addr))) {
-        /* Unable to bind socket */
+    opt = 0;
+    if ((AF_INET6 == family) && (0 > setsockopt(worker->type.listenner.socket, IPPROTO_IPV6, IPV6_V6ONLY, (char *)&opt, sizeof(opt)))) {
+        /* Unable to set socket option */
         close(worker->type.listenner.socket);
         if (NULL != sock->cb.error.fct) {
-            sock->cb.error.fct(sock, "sock: unable to bind socket", sock->cb.error.user);
+            sock->cb.error.fct(sock, "sock: unable to set socket option IPV6_V6ONLY", sock->cb.error.user);
         }
         goto END;
     }
 
-    /* Invoke bind callback if defined */
-    if (NULL != sock->cb.bind.fct) {
-        struct sockaddr_in addr_bind;
-        size_t             size = sizeof(addr_bind);
-        getsockname(worker->type.listenner.socket, (struct sockaddr *)&addr_bind, (socklen_t *)&size);
-        uint16_t port = ntohs(addr_bind.sin_port);
-        sock->cb.bind.fct(sock, port, sock->cb.bind.user);
+    /* Bind socket, the file of a Unix domain socket remaining from a previous instance is removed, any other file is kept and binding fails */
+    struct sockaddr_storage addr;
+    socklen_t               addr_size;
+    memset(&addr, 0, sizeof(addr));
+    if (NULL != worker->type.listenner.path) {
+        struct sockaddr_un *addr_un = (struct sockaddr_un *)&addr;
+        addr_un->sun_family         = AF_UNIX;
+        strncpy(addr_un->sun_path, worker->type.listenner.path, sizeof(addr_un->sun_path) - 1);
+        addr_size = sizeof(struct sockaddr_un);
+        sock_ipc_unlink(worker->type.listenner.path);
+    } else if (AF_INET6 == family) {
+        struct sockaddr_in6 *addr_in6 = (struct sockaddr_in6 *)&addr;
+        addr_in6->sin6_family         = AF_INET6;
+        addr_in6->sin6_addr           = in6addr_any;
+        addr_in6->sin6_port           = htons(worker->type.listenner.port);
+        addr_size                     = sizeof(struct sockaddr_in6);
+    } else {
+        struct sockaddr_in *addr_in = (struct sockaddr_in *)&addr;
+        addr_in->sin_family         = AF_INET;
+        addr_in->sin_addr.s_addr    = INADDR_ANY;
+        addr_in->sin_port           = htons(worker->type.listenner.port);
+        addr_size                   = sizeof(struct sockaddr_in);
+    }
+    if (0 > bind(worker->type.listenner.socket, (struct sockaddr *)&addr, addr_size)) {
+        /* Unable to bind socket */
+        close(worker->type.listenner.socket);
+        if (NULL != sock->cb.error.fct) {
+            sock->cb.error.fct(sock, "sock: unable to bind socket", sock->cb.error.user);
+        }
+        goto END;
+    }
+
+    /* Invoke bind callback if defined, port is 0 for Unix domain sockets */
+    if ((NULL != sock->cb.bind.fct) && (NULL != worker->type.listenner.path)) {
+        sock->cb.bind.fct(sock, 0, sock->cb.bind.user);
+    } else if (NULL != sock->cb.bind.fct) {
+        struct sockaddr_storage addr_bind;
+        socklen_t               size = sizeof(addr_bind);
+        getsockname(worker->type.listenner.socket, (struct sockaddr *)&addr_bind, &size);
+        uint16_t port = ntohs((AF_INET6 == addr_bind.ss_family) ? ((struct sockaddr_in6 *)&addr_bind)->sin6_port : ((struct sockaddr_in *)&addr_bind)->sin_port);
+        sock->cb.bind.fct(sock, port, sock->cb.bind.user);
     }
 
     /* Listen for clients */
@@ -464,7 +1246,7 @@ sock_thread_listenner(void *arg) {
 
         /* Block until input arrives on one or more active sockets */
         fd_set         fds = worker->type.listenner.fds;
-        struct timeval tv  = { 5, 0 };
+        struct timeval tv  = { (true == sock->options.spin) ? 0 : 5, 0 };
         if (0 > select(FD_SETSIZE, &fds, NULL, NULL, &tv)) {
             /* Unable to select */
         }
@@ -474,12 +1256,16 @@ sock_thread_listenner(void *arg) {
             if (FD_ISSET(index, &fds)) {
                 if (worker->type.listenner.socket == index) {
                     /* Connection request on socket */
-                    int                c;
-                    struct sockaddr_in addr_client;
-                    size_t             size = sizeof(addr_client);
-                    if (0 > (c = accept(worker->type.listenner.socket, (struct sockaddr *)&addr_client, (socklen_t *)&size))) {
+                    int                     c;
+                    struct sockaddr_storage addr_client;
+                    socklen_t               size = sizeof(addr_client);
+                    if (0 > (c = accept(worker->type.listenner.socket, (struct sockaddr *)&addr_client, &size))) {
                         /* Unable to accept the client */
                     } else {
+                        /* Set socket options */
+                        if ((0 != sock_setup(sock, c, (NULL == worker->type.listenner.path))) && (NULL != sock->cb.error.fct)) {
+                            sock->cb.error.fct(sock, "sock: unable to set client socket options", sock->cb.error.user);
+                        }
                         /* Add new client to my FDs and parent clients */
                         FD_SET(c, &worker->type.listenner.fds);
                         sem_wait(&sock->clients.sem);
@@ -502,18 +1288,22 @@ sock_thread_listenner(void *arg) {
                             if (NULL != w->type.messenger.buffer) {
                                 /* Read from socket */
                                 if (size == read(index, w->type.messenger.buffer, size)) {
-                                    /* Start messenger */
-                                    if (0 != sock_start_worker(sock, &sock->messengers, w, sock_thread_messenger)) {
-                                        /* Unable to start the worker */
+                                    /* Dispatch data */
+                                    if (0 != sock_dispatch(sock, w)) {
+                                        /* Unable to dispatch the data */
                                         free(w->type.messenger.buffer);
                                         free(w);
                                     }
                                 } else {
                                     /* Unable to receive data, close socket */
+                                    if (NULL != sock->cb.close.fct) {
+                                        sock->cb.close.fct(sock, index, sock->cb.close.user);
+                                    }
                                     FD_CLR(index, &worker->type.listenner.fds);
                                     sem_wait(&sock->clients.sem);
                                     FD_CLR(index, &sock->clients.fds);
                                     sem_post(&sock->clients.sem);
+                                    sock_completions_drop(sock, index);
                                     close(index);
                                     free(w->type.messenger.buffer);
                                     free(w);
@@ -523,12 +1313,16 @@ sock_thread_listenner(void *arg) {
                                 free(w);
                             }
                         }
-                    } else {
+                    } else if (false == sock_completions_read(sock, index)) {
                         /* Unable to receive data, close socket */
+                        if (NULL != sock->cb.close.fct) {
+                            sock->cb.close.fct(sock, index, sock->cb.close.user);
+                        }
                         FD_CLR(index, &worker->type.listenner.fds);
                         sem_wait(&sock->clients.sem);
                         FD_CLR(index, &sock->clients.fds);
                         sem_post(&sock->clients.sem);
+                        sock_completions_drop(sock, index);
                         close(index);
                     }
                 }
@@ -545,6 +1339,9 @@ sock_thread_listenner(void *arg) {
 
     /* Close my own socket */
     close(worker->type.listenner.socket);
+    if (NULL != worker->type.listenner.path) {
+        sock_ipc_unlink(worker->type.listenner.path);
+    }
 
 END:
 
@@ -552,6 +1349,7 @@ END:
     sock_remove_worker(sock, &sock->listenners, worker);
 
     /* Release memory */
+    free(worker->type.listenner.path);
     free(worker);
 
     return NULL;
@@ -574,27 +1372,52 @@ sock_thread_reader(void *arg) {
     int  retry     = 100;   /* Connection retry timeout */
     bool connected = false; /* Connection status */
 
+    /* Set thread name */
+    char name[16];
+    if (true == worker->type.reader.ipc) {
+        snprintf(name, sizeof(name), "axon-conn:ipc");
+    } else {
+        snprintf(name, sizeof(name), "axon-conn:%u", worker->type.reader.port);
+    }
+    pthread_setname_np(pthread_self(), name);
+
     /* Infinite loop */
     while (1) {
 
-        /* Create new SOCK_STREAM socket */
-        worker->type.reader.socket = socket(AF_INET, SOCK_STREAM, 0);
-        if (0 > worker->type.reader.socket) {
-            /* Unable to create socket */
-            retry = (int)(retry * 1.5);
-            if (retry > 5000)
-                retry = 5000;
-            usleep(retry * 1000);
-            continue;
+        /* Retrieve the addresses of the server, hostnames are resolved once and then in the background when their addresses are outdated */
+        struct sockaddr_storage addrs[RESOLVER_ADDRESSES];
+        socklen_t               sizes[RESOLVER_ADDRESSES];
+        size_t                  count = 1;
+        if (true == worker->type.reader.ipc) {
+            struct sockaddr_un *addr_un = (struct sockaddr_un *)&addrs[0];
+            memset(&addrs[0], 0, sizeof(struct sockaddr_storage));
+            addr_un->sun_family = AF_UNIX;
+            strncpy(addr_un->sun_path, worker->type.reader.hostname, sizeof(addr_un->sun_path) - 1);
+            sizes[0] = sizeof(struct sockaddr_un);
+        } else {
+            count = resolver_lookup(sock->resolver, worker->type.reader.hostname, worker->type.reader.port, addrs, sizes);
         }
 
-        /* Connect to the server */
-        struct sockaddr_in addr;
-        addr.sin_family      = AF_INET;
-        addr.sin_addr.s_addr = inet_addr(worker->type.reader.hostname);
-        addr.sin_port        = htons(worker->type.reader.port);
-        if (0 > connect(worker->type.reader.socket, (struct sockaddr *)&addr, sizeof(addr))) {
-            /* Unable to connect socket */
+        /* Connect to the first address of the server which is reachable */
+        worker->type.reader.socket = -1;
+        for (size_t index = 0; (index < count) && (0 > worker->type.reader.socket); index++) {
+            int tmp = socket(addrs[index].ss_family, SOCK_STREAM, 0);
+            if (0 > tmp) {
+                /* Unable to create socket */
+                continue;
+            }
+            if (0 > connect(tmp, (struct sockaddr *)&addrs[index], sizes[index])) {
+                /* Unable to connect socket */
+                close(tmp);
+                continue;
+            }
+            worker->type.reader.socket = tmp;
+        }
+        if (0 > worker->type.reader.socket) {
+            /* Unable to connect to the server, its addresses may have changed */
+            if (false == worker->type.reader.ipc) {
+                resolver_expire(sock->resolver, worker->type.reader.hostname, worker->type.reader.port);
+            }
             retry = (int)(retry * 1.5);
             if (retry > 5000)
                 retry = 5000;
@@ -604,6 +1427,11 @@ sock_thread_reader(void *arg) {
         retry     = 100;
         connected = true;
 
+        /* Set socket options */
+        if ((0 != sock_setup(sock, worker->type.reader.socket, !worker->type.reader.ipc)) && (NULL != sock->cb.error.fct)) {
+            sock->cb.error.fct(sock, "sock: unable to set server socket options", sock->cb.error.user);
+        }
+
         /* Initialize the set of active sockets, add myself to the set and parent clients */
         FD_ZERO(&worker->type.reader.fds);
         FD_SET(worker->type.reader.socket, &worker->type.reader.fds);
@@ -616,7 +1444,7 @@ sock_thread_reader(void *arg) {
 
             /* Block until input arrives on one or more active sockets */
             fd_set         fds = worker->type.reader.fds;
-            struct timeval tv  = { 5, 0 };
+            struct timeval tv  = { (true == sock->options.spin) ? 0 : 5, 0 };
             int            tmp = select(FD_SETSIZE, &fds, NULL, NULL, &tv);
             if (0 > tmp) {
                 /* Unable to select */
@@ -633,24 +1461,29 @@ sock_thread_reader(void *arg) {
                         sock_worker_t *w = (sock_worker_t *)malloc(sizeof(sock_worker_t));
                         if (NULL != w) {
                             memset(w, 0, sizeof(sock_worker_t));
-                            /* Store size and create buffer */
+                            /* Store socket and size and create buffer */
+                            w->type.messenger.socket = index;
                             w->type.messenger.size   = size;
                             w->type.messenger.buffer = malloc(size);
                             if (NULL != w->type.messenger.buffer) {
                                 /* Read from socket */
                                 if (size == read(index, w->type.messenger.buffer, size)) {
-                                    /* Start messenger */
-                                    if (0 != sock_start_worker(sock, &sock->messengers, w, sock_thread_messenger)) {
-                                        /* Unable to start the worker */
+                                    /* Dispatch data */
+                                    if (0 != sock_dispatch(sock, w)) {
+                                        /* Unable to dispatch the data */
                                         free(w->type.messenger.buffer);
                                         free(w);
                                     }
                                 } else {
                                     /* Unable to receive data, close socket */
+                                    if (NULL != sock->cb.close.fct) {
+                                        sock->cb.close.fct(sock, index, sock->cb.close.user);
+                                    }
                                     FD_CLR(index, &worker->type.reader.fds);
                                     sem_wait(&sock->clients.sem);
                                     FD_CLR(index, &sock->clients.fds);
                                     sem_post(&sock->clients.sem);
+                                    sock_completions_drop(sock, index);
                                     close(index);
                                     free(w->type.messenger.buffer);
                                     free(w);
@@ -661,12 +1494,16 @@ sock_thread_reader(void *arg) {
                                 free(w);
                             }
                         }
-                    } else {
+                    } else if (false == sock_completions_read(sock, index)) {
                         /* Unable to receive data, close socket and reconnect again */
+                        if (NULL != sock->cb.close.fct) {
+                            sock->cb.close.fct(sock, index, sock->cb.close.user);
+                        }
                         FD_CLR(index, &worker->type.reader.fds);
                         sem_wait(&sock->clients.sem);
                         FD_CLR(index, &sock->clients.fds);
                         sem_post(&sock->clients.sem);
+                        sock_completions_drop(sock, index);
                         close(index);
                         connected = false;
                     }
@@ -675,147 +1512,1169 @@ sock_thread_reader(void *arg) {
         }
     }
 
-    /* Close my own socket */
-    sem_wait(&sock->clients.sem);
-    FD_CLR(worker->type.reader.socket, &sock->clients.fds);
-    sem_post(&sock->clients.sem);
-    close(worker->type.reader.socket);
+    /* Close my own socket */
+    sem_wait(&sock->clients.sem);
+    FD_CLR(worker->type.reader.socket, &sock->clients.fds);
+    sem_post(&sock->clients.sem);
+    sock_completions_drop(sock, worker->type.reader.socket);
+    close(worker->type.reader.socket);
+
+    /* Remove worker from readers */
+    sock_remove_worker(sock, &sock->readers, worker);
+
+    /* Release memory */
+    free(worker->type.reader.hostname);
+    free(worker);
+
+    return NULL;
+}
+
+/**
+ * @brief Sock thread used to handle data received
+ * @param arg Worker
+ * @return Always returns NULL
+ */
+static void *
+sock_thread_messenger(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Retrieve worker */
+    sock_worker_t *worker = (sock_worker_t *)arg;
+    sock_t *       sock   = worker->parent;
+
+    /* Set thread name */
+    pthread_setname_np(pthread_self(), "axon-messenger");
+
+    /* Check if message callback is define */
+    if (NULL != sock->cb.message.fct) {
+
+        /* Invoke message callback, it takes the ownership of the buffer */
+        void *buffer                  = worker->type.messenger.buffer;
+        worker->type.messenger.buffer = NULL;
+        sock->cb.message.fct(sock, buffer, worker->type.messenger.size, worker->type.messenger.socket, sock->cb.message.user);
+    }
+
+    /* Remove worker from messengers */
+    sock_remove_worker(sock, &sock->messengers, worker);
+
+    /* Release memory */
+    free(worker->type.messenger.buffer);
+    free(worker);
+
+    return NULL;
+}
+
+/**
+ * @brief Sock task used to handle data received when an executor is defined
+ * @param arg Worker
+ */
+static void
+sock_task_messenger(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Retrieve worker */
+    sock_worker_t *worker = (sock_worker_t *)arg;
+    sock_t *       sock   = worker->parent;
+
+    /* Check if message callback is define */
+    if (NULL != sock->cb.message.fct) {
+
+        /* Invoke message callback, it takes the ownership of the buffer */
+        void *buffer                  = worker->type.messenger.buffer;
+        worker->type.messenger.buffer = NULL;
+        sock->cb.message.fct(sock, buffer, worker->type.messenger.size, worker->type.messenger.socket, sock->cb.message.user);
+    }
+
+    /* Release memory */
+    free(worker->type.messenger.buffer);
+    free(worker);
+}
+
+/**
+ * @brief Sock thread used to send data
+ * @param arg Worker
+ * @return Always returns NULL
+ */
+static void *
+sock_thread_sender(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Retrieve worker */
+    sock_worker_t *worker = (sock_worker_t *)arg;
+    sock_t *       sock   = worker->parent;
+
+    /* Set thread name */
+    pthread_setname_np(pthread_self(), "axon-sender");
+
+    /* Block SIGPIPE when sending files because sendfile has no MSG_NOSIGNAL flag, the signal is discarded with the thread */
+    if (0 < worker->type.sender.count) {
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &set, NULL);
+    }
+
+    /* Check wanted destination */
+    if (SOCK_SEND_ROUND_ROBIN == worker->type.sender.socket) {
+
+        int socket = -1;
+        int retry  = 100;
+        int loop   = 0;
+
+        /* Search for the next client socket */
+        while (0 > socket) {
+            sem_wait(&sock->clients.sem);
+            for (int index = 0; index < FD_SETSIZE; index++) {
+                int tmp = (index + sock->clients.index + 1) % FD_SETSIZE;
+                if (FD_ISSET(tmp, &sock->clients.fds)) {
+                    socket = tmp;
+                }
+            }
+            sem_post(&sock->clients.sem);
+            if (0 > socket) {
+                retry = (int)(retry * 1.5);
+                if (retry > 5000) {
+                    retry = 5000;
+                    loop++;
+                    if (3 < loop) {
+                        goto END;
+                    }
+                }
+                usleep(retry * 1000);
+            }
+        }
+
+        /* Client socket found, send data */
+        if (0 != sock_transmit(sock, socket, worker)) {
+            /* Unable to send data */
+            sem_wait(&sock->clients.sem);
+            FD_CLR(socket, &sock->clients.fds);
+            sock_completions_drop(sock, socket);
+            close(socket);
+            sem_post(&sock->clients.sem);
+        }
+
+        /* Increase Round-Robin index */
+        sem_wait(&sock->clients.sem);
+        sock->clients.index = (sock->clients.index + 1) % FD_SETSIZE;
+        sem_post(&sock->clients.sem);
+
+    } else if (SOCK_SEND_BROADCAST == worker->type.sender.socket) {
+
+        /* Send data to all clients sockets */
+        sem_wait(&sock->clients.sem);
+        for (int index = 0; index < FD_SETSIZE; index++) {
+            if ((FD_ISSET(index, &sock->clients.fds))
+                && (0 != sock_transmit(sock, index, worker))) {
+                /* Unable to send data */
+                FD_CLR(index, &sock->clients.fds);
+                sock_completions_drop(sock, index);
+                close(index);
+            }
+        }
+        sem_post(&sock->clients.sem);
+
+    } else {
+
+        /* Send data to a single socket */
+        if (0 != sock_transmit(sock, worker->type.sender.socket, worker)) {
+            /* Unable to send data */
+            sem_wait(&sock->clients.sem);
+            FD_CLR(worker->type.sender.socket, &sock->clients.fds);
+            sock_completions_drop(sock, worker->type.sender.socket);
+            close(worker->type.sender.socket);
+            sem_post(&sock->clients.sem);
+        }
+    }
+
+END:
+
+    /* Remove worker from senders */
+    sock_remove_worker(sock, &sock->senders, worker);
+
+    /* Release files and memory */
+    for (size_t index = 0; index < worker->type.sender.count; index++) {
+        close(worker->type.sender.files[index].fd);
+    }
+    free(worker->type.sender.files);
+    sock_sender_release(sock, worker);
+    free(worker);
+
+    return NULL;
+}
+
+/**
+ * @brief Sock thread used to open a ring created by the peer and to read the ring if it is not a producer
+ * @param arg Ring
+ * @return Always returns NULL
+ */
+static void *
+sock_thread_ring(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Retrieve ring and sock instance */
+    sock_ring_t *ring = (sock_ring_t *)arg;
+    sock_t *     sock = ring->parent;
+
+    /* Set thread name */
+    pthread_setname_np(pthread_self(), "axon-ring");
+
+    /* Loop until the instance is released */
+    while (false == atomic_load(&ring->stop)) {
+
+        /* Open the ring once it has been created by the peer */
+        if (false == sock_ring_opened(ring)) {
+            if (true == ring->local) {
+                inproc_t *queue = inproc_open(ring->name);
+                if (NULL == queue) {
+                    usleep(100000);
+                    continue;
+                }
+                if ((false == ring->producer) && (true == atomic_exchange(&queue->consumer, true))) {
+                    /* The queue can only be read by a single consumer */
+                    inproc_release(queue, false);
+                    if (NULL != sock->cb.error.fct) {
+                        sock->cb.error.fct(sock, "sock: unable to read in-process queue, it already has a consumer", sock->cb.error.user);
+                    }
+                    break;
+                }
+                atomic_store(&ring->queue, queue);
+            } else {
+                ring_t *tmp = ring_open(ring->name);
+                if (NULL == tmp) {
+                    usleep(100000);
+                    continue;
+                }
+                if (0 != ring_claim(tmp, ring->producer)) {
+                    /* The ring links a single producer to a single consumer */
+                    ring_release(tmp, false);
+                    if (NULL != sock->cb.error.fct) {
+                        sock->cb.error.fct(sock,
+                                           (true == ring->producer) ? "sock: unable to open shared memory ring, it already has a producer"
+                                                                    : "sock: unable to open shared memory ring, it already has a consumer",
+                                           sock->cb.error.user);
+                    }
+                    break;
+                }
+                atomic_store(&ring->ring, tmp);
+            }
+        }
+
+        /* Nothing else to do for producers */
+        if (true == ring->producer) {
+            break;
+        }
+
+        /* Read the data available, waiting at most 100ms so that the stop request is checked */
+        void * buffer = NULL;
+        size_t size   = 0;
+        if (0 == ((true == ring->local) ? inproc_read(atomic_load(&ring->queue), &buffer, &size, 100) : ring_read(atomic_load(&ring->ring), &buffer, &size, 100))) {
+
+            /* Dispatch data */
+            sock_dispatch_data(sock, buffer, size);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Sock thread used to receive the datagrams of the multicast group
+ * @param arg Sock instance
+ * @return Always returns NULL
+ */
+static void *
+sock_thread_multicast(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Retrieve sock instance */
+    sock_t *sock = (sock_t *)arg;
+
+    /* Set thread name */
+    pthread_setname_np(pthread_self(), "axon-mcast");
+
+    /* Loop until the instance is released */
+    while (false == atomic_load(&sock->multicast.stop)) {
+
+        /* Receive the datagrams available, waiting at most 100ms so that the stop request is checked */
+        void *   buffer = NULL;
+        size_t   size   = 0;
+        uint64_t lost   = 0;
+        int      ret    = mcast_receive(sock->multicast.mcast, &buffer, &size, &lost, 100);
+
+        /* Report the datagrams lost, the messages they hold are missing */
+        if ((0 < lost) && (NULL != sock->cb.error.fct)) {
+            char str[64];
+            snprintf(str, sizeof(str), "sock: %llu multicast datagrams lost", (unsigned long long)lost);
+            sock->cb.error.fct(sock, str, sock->cb.error.user);
+        }
+
+        /* Dispatch data */
+        if (0 == ret) {
+            sock_dispatch_data(sock, buffer, size);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Dispatch data received from a ring or a multicast group, there is no socket associated to them
+ * @param sock Sock instance
+ * @param buffer Data received, released by the function if they can't be dispatched
+ * @param size Size of data received
+ */
+static void
+sock_dispatch_data(sock_t *sock, void *buffer, size_t size) {
+
+    /* Create new messenger, there is no socket associated to the data */
+    sock_worker_t *w = (sock_worker_t *)malloc(sizeof(sock_worker_t));
+    if (NULL == w) {
+        /* Unable to allocate memory */
+        free(buffer);
+        return;
+    }
+    memset(w, 0, sizeof(sock_worker_t));
+    w->type.messenger.socket = -1;
+    w->type.messenger.buffer = buffer;
+    w->type.messenger.size   = size;
+
+    /* Dispatch data */
+    if (0 != sock_dispatch(sock, w)) {
+        /* Unable to dispatch the data */
+        free(w->type.messenger.buffer);
+        free(w);
+    }
+}
+
+/**
+ * @brief Send data to the rings
+ * @param sock Sock instance
+ * @param buffer Buffer to be sent, released if it has been sent to all its destinations
+ * @param size Size of buffer to send
+ * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @return 1 if the data have been sent to all their destinations, 0 if they should be sent to the sockets, -1 otherwise, rings unable to receive broadcasted data are reported with the error callback
+ */
+static int
+sock_ring_send(sock_t *sock, void *buffer, size_t size, int socket) {
+
+    int          ret   = 0;
+    unsigned int count = 0;
+
+    /* Data sent to a single socket are not concerned */
+    if (0 <= socket) {
+        return 0;
+    }
+
+    /* Count the opened producer rings whose consumer is present, the last in-process queue may receive the buffer itself */
+    int          peers = sock_count(sock);
+    sock_ring_t *last  = NULL;
+    sem_wait(&sock->rings.sem);
+    for (sock_ring_t *ring = sock->rings.first; NULL != ring; ring = ring->next) {
+        if ((true == ring->producer) && (true == sock_ring_ready(ring))) {
+            count++;
+            last = (true == ring->local) ? ring : last;
+        }
+    }
+
+    /* Send data to all the rings, a ring which can't receive them does not prevent sending them to the other destinations, or to the next ring if its turn has come, sockets are part of the Round-Robin */
+    bool         handover = false;
+    unsigned int failures = 0;
+    if (SOCK_SEND_BROADCAST == socket) {
+        last = (peers <= (int)count) ? last : NULL;
+        for (sock_ring_t *ring = sock->rings.first; NULL != ring; ring = ring->next) {
+            if ((true == ring->producer) && (true == sock_ring_ready(ring)) && (last != ring) && (0 != sock_ring_write(ring, buffer, size, false))) {
+                /* Unable to send data */
+                failures++;
+            }
+        }
+        if (NULL != last) {
+            /* The buffer is given to the last in-process queue as there is no other destination left */
+            if (0 != sock_ring_write(last, buffer, size, true)) {
+                /* Unable to send data */
+                failures++;
+            } else {
+                handover = true;
+            }
+        }
+        if ((0 < count) && (peers <= (int)count)) {
+            /* There is no socket */
+            ret = 1;
+        }
+    } else if (0 < count) {
+        unsigned int index = sock->rings.index++ % (count + ((peers > (int)count) ? 1 : 0));
+        for (sock_ring_t *ring = sock->rings.first; (NULL != ring) && (0 == ret); ring = ring->next) {
+            if ((true == ring->producer) && (true == sock_ring_ready(ring)) && (0 == index--)) {
+                ret      = (0 == sock_ring_write(ring, buffer, size, ring->local)) ? 1 : -1;
+                handover = (1 == ret) && (true == ring->local);
+            }
+        }
+    }
+
+    /* Release semaphore */
+    sem_post(&sock->rings.sem);
+
+    /* Report the rings which have not received the broadcasted data, once the semaphore is released so that the callback may use the instance */
+    if ((0 < failures) && (NULL != sock->cb.error.fct)) {
+        char str[64];
+        snprintf(str, sizeof(str), "sock: unable to write data to %u rings", failures);
+        sock->cb.error.fct(sock, str, sock->cb.error.user);
+    }
+
+    /* Release the data sent to all their destinations, unless they have been given to an in-process queue */
+    if ((1 == ret) && (false == handover)) {
+        free(buffer);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Write data to a ring opened by the instance
+ * @param ring Ring
+ * @param buffer Buffer to be sent
+ * @param size Size of buffer to send
+ * @param handover true if the buffer is given to the in-process queue instead of being copied, it is then released by the peer
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+sock_ring_write(sock_ring_t *ring, void *buffer, size_t size, bool handover) {
+
+    /* Shared memory rings copy the data */
+    if (false == ring->local) {
+        return ring_write(atomic_load(&ring->ring), buffer, size, ring->parent->options.ring.timeout);
+    }
+
+    /* In-process queues take the buffer, it is copied if it is sent to other destinations */
+    void *data = buffer;
+    if ((false == handover) && (NULL == (data = malloc(size)))) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    if (false == handover) {
+        memcpy(data, buffer, size);
+    }
+    if (0 != inproc_write(atomic_load(&ring->queue), data, size)) {
+        /* Unable to send data */
+        if (false == handover) {
+            free(data);
+        }
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Check if a ring has been opened by the instance
+ * @param ring Ring
+ * @return true if the ring is opened, false if it is waiting for the peer to create it
+ */
+static bool
+sock_ring_opened(sock_ring_t *ring) {
+
+    return (true == ring->local) ? (NULL != atomic_load(&ring->queue)) : (NULL != atomic_load(&ring->ring));
+}
+
+/**
+ * @brief Check if data can be written to a ring opened by the instance
+ * @param ring Ring
+ * @return true if the ring is opened and its consumer is present, false otherwise
+ */
+static bool
+sock_ring_ready(sock_ring_t *ring) {
+
+    /* Shared memory rings are written once the consumer has claimed them */
+    if (false == ring->local) {
+        ring_t *tmp = atomic_load(&ring->ring);
+        return (NULL != tmp) && (0 != atomic_load(&tmp->header->consumer));
+    }
+
+    /* In-process queues are written once the consumer has claimed them, they would grow without limit otherwise */
+    inproc_t *queue = atomic_load(&ring->queue);
+    return (NULL != queue) && (true == atomic_load(&queue->consumer));
+}
+
+/**
+ * @brief Add a ring to the sock instance
+ * @param sock Sock instance
+ * @param name Name of the shared memory object or of the in-process queue
+ * @param producer true if data are sent to the ring, false if they are received from the ring
+ * @param local true if the ring is an in-process queue, false if it is a shared memory ring
+ * @param ring Shared memory ring if it is created by the instance, NULL otherwise
+ * @param queue In-process queue if it is created by the instance, NULL otherwise
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+sock_add_ring(sock_t *sock, char *name, bool producer, bool local, ring_t *ring, inproc_t *queue) {
+
+    /* Create new ring */
+    sock_ring_t *tmp = (sock_ring_t *)malloc(sizeof(sock_ring_t));
+    if (NULL == tmp) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    memset(tmp, 0, sizeof(sock_ring_t));
+    if (NULL == (tmp->name = strdup(name))) {
+        /* Unable to allocate memory */
+        free(tmp);
+        return -1;
+    }
+    tmp->parent   = sock;
+    tmp->producer = producer;
+    tmp->owner    = (NULL != ring) || (NULL != queue);
+    tmp->local    = local;
+    atomic_store(&tmp->ring, ring);
+    atomic_store(&tmp->queue, queue);
+    atomic_store(&tmp->stop, false);
+
+    /* Start the thread opening the ring created by the peer or reading the ring */
+    if ((false == tmp->owner) || (false == producer)) {
+        if (0 != pthread_create(&tmp->thread, NULL, sock_thread_ring, tmp)) {
+            /* Unable to start the thread */
+            free(tmp->name);
+            free(tmp);
+            return -1;
+        }
+        tmp->started = true;
+    }
+
+    /* Add the ring */
+    sem_wait(&sock->rings.sem);
+    tmp->next         = sock->rings.first;
+    sock->rings.first = tmp;
+    sem_post(&sock->rings.sem);
+
+    return 0;
+}
+
+/**
+ * @brief Sock thread used to flush the batches when their deadline is reached
+ * @param arg Sock instance
+ * @return Always returns NULL
+ */
+static void *
+sock_thread_flusher(void *arg) {
+
+    assert(NULL != arg);
+
+    /* Retrieve sock instance */
+    sock_t *sock = (sock_t *)arg;
+
+    /* Set thread name */
+    pthread_setname_np(pthread_self(), "axon-flusher");
+
+    /* Infinite loop */
+    while (1) {
+
+        /* Flush the batches whose deadline is reached and retrieve the next deadline, the thread is not cancelled while holding the semaphore */
+        struct timespec now, next = { 0, 0 };
+        int             state;
+        unsigned int    dropped = 0;
+        clock_gettime(CLOCK_REALTIME, &now);
+        sem_wait(&sock->batches.sem);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &state);
+        sock_batch_t *batch = sock->batches.first;
+        while (NULL != batch) {
+            sock_batch_t *tmp = batch;
+            batch             = batch->next;
+            if ((tmp->deadline.tv_sec < now.tv_sec) || ((tmp->deadline.tv_sec == now.tv_sec) && (tmp->deadline.tv_nsec <= now.tv_nsec))) {
+                if (0 != sock_batch_flush(sock, tmp)) {
+                    /* Unable to send data */
+                    dropped++;
+                }
+            } else if ((0 == next.tv_sec) || (tmp->deadline.tv_sec < next.tv_sec) || ((tmp->deadline.tv_sec == next.tv_sec) && (tmp->deadline.tv_nsec < next.tv_nsec))) {
+                next = tmp->deadline;
+            }
+        }
+        pthread_setcancelstate(state, NULL);
+        sem_post(&sock->batches.sem);
+
+        /* Report the batches which have not been sent */
+        while (0 < dropped--) {
+            sock_batch_dropped(sock);
+        }
+
+        /* Wait for the next deadline or for a new batch */
+        if (0 == next.tv_sec) {
+            sem_wait(&sock->batches.signal);
+        } else {
+            sem_timedwait(&sock->batches.signal, &next);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Start a new sender
+ * @param sock Sock instance
+ * @param buffer Buffer to be sent, released once it is sent
+ * @param size Size of buffer to send
+ * @param files Parts of files sent within the buffer, released once they are sent, NULL if there is none
+ * @param count Amount of parts of files
+ * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+sock_start_sender(sock_t *sock, void *buffer, size_t size, sock_file_t *files, size_t count, int socket) {
+
+    /* Create new sender */
+    sock_worker_t *worker = (sock_worker_t *)malloc(sizeof(sock_worker_t));
+    if (NULL == worker) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    memset(worker, 0, sizeof(sock_worker_t));
+
+    /* Store buffer, size, files and socket */
+    worker->type.sender.buffer = buffer;
+    worker->type.sender.size   = size;
+    worker->type.sender.files  = files;
+    worker->type.sender.count  = count;
+    worker->type.sender.socket = socket;
+
+    /* Start sender */
+    if (0 != sock_start_worker(sock, &sock->senders, worker, sock_thread_sender, &sock->options.affinity.worker)) {
+        /* Unable to start the worker */
+        free(worker);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Add data to the batch of their destination, the batch is flushed if it is full
+ * @param sock Sock instance
+ * @param buffer Buffer to be sent, released once it is copied
+ * @param size Size of buffer to send
+ * @param socket Socket to which the data should be sent, SOCK_SEND_BROADCAST or SOCK_SEND_ROUND_ROBIN
+ * @return 0 if the function succeeded or if the data have been copied to the batch, -1 if the buffer has not been released
+ */
+static int
+sock_batch_add(sock_t *sock, void *buffer, size_t size, int socket) {
+
+    bool signal = false;
+
+    /* Wait semaphore */
+    sem_wait(&sock->batches.sem);
+
+    /* Start the flusher thread with the first batch */
+    if (false == sock->batches.started) {
+        if (0 != pthread_create(&sock->batches.thread, NULL, sock_thread_flusher, sock)) {
+            /* Unable to start the thread */
+            sem_post(&sock->batches.sem);
+            return sock_start_sender(sock, buffer, size, NULL, 0, socket);
+        }
+        sock->batches.started = true;
+    }
+
+    /* Search the batch of the destination */
+    sock_batch_t *batch = sock->batches.first;
+    while ((NULL != batch) && (socket != batch->socket)) {
+        batch = batch->next;
+    }
+
+    /* Data larger than the batch size are sent immediately, after the data already held to keep them in order */
+    if (size >= sock->options.batch.size) {
+        bool dropped = ((NULL != batch) && (0 != sock_batch_flush(sock, batch)));
+        sem_post(&sock->batches.sem);
+        if (true == dropped) {
+            sock_batch_dropped(sock);
+        }
+        return sock_start_sender(sock, buffer, size, NULL, 0, socket);
+    }
+
+    /* Create a new batch, its deadline is computed from the first data held */
+    if (NULL == batch) {
+        if (NULL == (batch = (sock_batch_t *)malloc(sizeof(sock_batch_t)))) {
+            /* Unable to allocate memory */
+            sem_post(&sock->batches.sem);
+            return sock_start_sender(sock, buffer, size, NULL, 0, socket);
+        }
+        memset(batch, 0, sizeof(sock_batch_t));
+        batch->socket = socket;
+        clock_gettime(CLOCK_REALTIME, &batch->deadline);
+        batch->deadline.tv_nsec += (long)sock->options.batch.delay * 1000;
+        batch->deadline.tv_sec += batch->deadline.tv_nsec / 1000000000;
+        batch->deadline.tv_nsec %= 1000000000;
+        batch->next         = sock->batches.first;
+        sock->batches.first = batch;
+        signal              = true;
+    }
+
+    /* Copy the data at the end of the batch */
+    if (batch->size + size > batch->capacity) {
+        size_t   capacity = sock->options.batch.size + size;
+        uint8_t *tmp      = (uint8_t *)realloc(batch->buffer, capacity);
+        if (NULL == tmp) {
+            /* Unable to allocate memory */
+            bool dropped = (0 != sock_batch_flush(sock, batch));
+            sem_post(&sock->batches.sem);
+            if (true == dropped) {
+                sock_batch_dropped(sock);
+            }
+            return sock_start_sender(sock, buffer, size, NULL, 0, socket);
+        }
+        batch->buffer   = tmp;
+        batch->capacity = capacity;
+    }
+    memcpy(&batch->buffer[batch->size], buffer, size);
+    batch->size += size;
+    free(buffer);
+
+    /* Flush the batch if it is full, the data are owned by the batch so they are dropped if they can't be sent */
+    bool dropped = false;
+    if (batch->size >= sock->options.batch.size) {
+        dropped = (0 != sock_batch_flush(sock, batch));
+        signal  = false;
+    }
+
+    /* Release semaphore */
+    sem_post(&sock->batches.sem);
 
-    /* Remove worker from readers */
-    sock_remove_worker(sock, &sock->readers, worker);
+    /* Report the data dropped */
+    if (true == dropped) {
+        sock_batch_dropped(sock);
+    }
 
-    /* Release memory */
-    free(worker->type.reader.hostname);
-    free(worker);
+    /* Wake up the flusher thread so that it takes into account the deadline of the new batch */
+    if (true == signal) {
+        sem_post(&sock->batches.signal);
+    }
 
-    return NULL;
+    return 0;
 }
 
 /**
- * @brief Sock thread used to handle data received
- * @param arg Worker
- * @return Always returns NULL
+ * @brief Flush a batch, it is removed from the batches and released, batches semaphore must be held
+ * @param sock Sock instance
+ * @param batch Batch to flush
+ * @return 0 if the function succeeded, -1 otherwise
  */
-static void *
-sock_thread_messenger(void *arg) {
+static int
+sock_batch_flush(sock_t *sock, sock_batch_t *batch) {
 
-    assert(NULL != arg);
+    int ret = 0;
 
-    /* Retrieve worker */
-    sock_worker_t *worker = (sock_worker_t *)arg;
-    sock_t *       sock   = worker->parent;
+    /* Remove the batch */
+    sock_batch_t **curr = &sock->batches.first;
+    while (batch != *curr) {
+        curr = &(*curr)->next;
+    }
+    *curr = batch->next;
 
-    /* Check if message callback is define */
-    if (NULL != sock->cb.message.fct) {
+    /* Send the data held, the sender releases the buffer */
+    if (0 < batch->size) {
+        if (0 != (ret = sock_start_sender(sock, batch->buffer, batch->size, NULL, 0, batch->socket))) {
+            /* Unable to start the sender */
+            free(batch->buffer);
+        }
+    } else {
+        free(batch->buffer);
+    }
+    free(batch);
+
+    return ret;
+}
+
+/**
+ * @brief Report the data of a batch dropped because it can't be sent, batches semaphore must be released so that the callback may use the instance
+ * @param sock Sock instance
+ */
+static void
+sock_batch_dropped(sock_t *sock) {
 
-        /* Invoke message callback */
-        sock->cb.message.fct(sock, worker->type.messenger.buffer, worker->type.messenger.size, worker->type.messenger.socket, sock->cb.message.user);
+    /* Invoke the error callback */
+    if (NULL != sock->cb.error.fct) {
+        sock->cb.error.fct(sock, "sock: unable to send batch, data dropped", sock->cb.error.user);
     }
+}
 
-    /* Remove worker from messengers */
-    sock_remove_worker(sock, &sock->messengers, worker);
+/**
+ * @brief Dispatch data received to a new messenger, to the executor or inline in spin or inline mode
+ * @param sock Sock instance
+ * @param worker Messenger holding the data received
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+sock_dispatch(sock_t *sock, sock_worker_t *worker) {
 
-    /* Release memory */
-    free(worker->type.messenger.buffer);
-    free(worker);
+    /* Invoke the message callback from the listenner or reader thread in spin or inline mode */
+    if ((true == sock->options.spin) || (true == sock->options.direct)) {
+        worker->parent = sock;
+        sock_task_messenger(worker);
+        return 0;
+    }
 
-    return NULL;
+    /* Retrieve the CPU which received the packets if wanted */
+    int cpu = sock_incoming_cpu(sock, worker->type.messenger.socket);
+
+    /* Start a new messenger if there is no executor */
+    if (NULL == sock->executor) {
+        if (0 <= cpu) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+            return sock_start_worker(sock, &sock->messengers, worker, sock_thread_messenger, &cpus);
+        }
+        return sock_start_worker(sock, &sock->messengers, worker, sock_thread_messenger, &sock->options.affinity.worker);
+    }
+
+    /* Submit data to the executor, data received from the same socket are kept in order if wanted */
+    worker->parent = sock;
+    return executor_submit(sock->executor, (true == sock->options.ordered) ? worker->type.messenger.socket : -1, cpu, sock_task_messenger, worker);
 }
 
 /**
- * @brief Sock thread used to send data
- * @param arg Worker
- * @return Always returns NULL
+ * @brief Retrieve the CPU which received the last packets of a socket
+ * @param sock Sock instance
+ * @param socket Socket
+ * @return CPU index, -1 if it is unknown or if the option is disabled
  */
-static void *
-sock_thread_sender(void *arg) {
+static int
+sock_incoming_cpu(sock_t *sock, int socket) {
 
-    assert(NULL != arg);
+    int       cpu  = -1;
+    socklen_t size = sizeof(cpu);
 
-    /* Retrieve worker */
-    sock_worker_t *worker = (sock_worker_t *)arg;
-    sock_t *       sock   = worker->parent;
+    /* Check if the option is enabled */
+    if (false == sock->options.affinity.incoming) {
+        return -1;
+    }
 
-    /* Check wanted destination */
-    if (SOCK_SEND_ROUND_ROBIN == worker->type.sender.socket) {
+    /* Retrieve the CPU, it is ignored if it is not part of the CPUs on which workers are pinned */
+    if (0 > getsockopt(socket, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &size)) {
+        return -1;
+    }
+    if ((0 > cpu) || (CPU_SETSIZE <= cpu) || ((0 < CPU_COUNT(&sock->options.affinity.worker)) && (!CPU_ISSET(cpu, &sock->options.affinity.worker)))) {
+        return -1;
+    }
 
-        int socket = -1;
-        int retry  = 100;
-        int loop   = 0;
+    return cpu;
+}
 
-        /* Search for the next client socket */
-        while (0 > socket) {
-            sem_wait(&sock->clients.sem);
-            for (int index = 0; index < FD_SETSIZE; index++) {
-                int tmp = (index + sock->clients.index + 1) % FD_SETSIZE;
-                if (FD_ISSET(tmp, &sock->clients.fds)) {
-                    socket = tmp;
-                }
-            }
-            sem_post(&sock->clients.sem);
-            if (0 > socket) {
-                retry = (int)(retry * 1.5);
-                if (retry > 5000) {
-                    retry = 5000;
-                    loop++;
-                    if (3 < loop) {
-                        goto END;
-                    }
-                }
-                usleep(retry * 1000);
-            }
+/**
+ * @brief Apply the TCP options to an accepted or connected socket
+ * @param sock Sock instance
+ * @param socket Socket
+ * @param tcp true if the socket is a TCP socket, false if it is a Unix domain socket to which only the buffer sizes and busy polling apply
+ * @return 0 if the function succeeded, -1 if at least one option could not be set
+ */
+static int
+sock_setup(sock_t *sock, int socket, bool tcp) {
+
+    int ret = 0;
+    int opt;
+
+    /* Disable Nagle algorithm */
+    if ((true == tcp) && (true == sock->options.tcp.nodelay)) {
+        opt = 1;
+        if (0 > setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt))) {
+            ret = -1;
         }
+    }
 
-        /* Client socket found, send data */
-        if (worker->type.sender.size != send(socket, worker->type.sender.buffer, worker->type.sender.size, MSG_NOSIGNAL)) {
+    /* Set buffer sizes */
+    if ((0 < sock->options.tcp.sndbuf) && (0 > setsockopt(socket, SOL_SOCKET, SO_SNDBUF, &sock->options.tcp.sndbuf, sizeof(int)))) {
+        ret = -1;
+    }
+    if ((0 < sock->options.tcp.rcvbuf) && (0 > setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &sock->options.tcp.rcvbuf, sizeof(int)))) {
+        ret = -1;
+    }
+
+    /* Set user timeout */
+    if ((true == tcp) && (0 < sock->options.tcp.user_timeout) && (0 > setsockopt(socket, IPPROTO_TCP, TCP_USER_TIMEOUT, &sock->options.tcp.user_timeout, sizeof(int)))) {
+        ret = -1;
+    }
+
+    /* Enable keepalive */
+    if ((true == tcp) && (0 < sock->options.tcp.keepalive.idle)) {
+        opt = 1;
+        if ((0 > setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, &opt, sizeof(opt)))
+            || (0 > setsockopt(socket, IPPROTO_TCP, TCP_KEEPIDLE, &sock->options.tcp.keepalive.idle, sizeof(int)))) {
+            ret = -1;
+        }
+        if ((0 < sock->options.tcp.keepalive.interval)
+            && (0 > setsockopt(socket, IPPROTO_TCP, TCP_KEEPINTVL, &sock->options.tcp.keepalive.interval, sizeof(int)))) {
+            ret = -1;
+        }
+        if ((0 < sock->options.tcp.keepalive.count) && (0 > setsockopt(socket, IPPROTO_TCP, TCP_KEEPCNT, &sock->options.tcp.keepalive.count, sizeof(int)))) {
+            ret = -1;
+        }
+    }
+
+    /* Enable busy polling */
+    if ((0 < sock->options.tcp.busy_poll) && (0 > setsockopt(socket, SOL_SOCKET, SO_BUSY_POLL, &sock->options.tcp.busy_poll, sizeof(int)))) {
+        ret = -1;
+    }
+
+    /* Enable zero-copy sends, the socket is flagged so that they are only used on sockets supporting them, the data in flight of a previous socket with the same descriptor are released */
+    bool zerocopy = false;
+    if ((true == tcp) && (0 < sock->options.zerocopy)) {
+        opt = 1;
+        if (0 > setsockopt(socket, SOL_SOCKET, SO_ZEROCOPY, &opt, sizeof(opt))) {
+            ret = -1;
+        } else {
+            zerocopy = true;
+        }
+    }
+    sem_wait(&sock->zerocopy.sem);
+    sock_completions_release(sock, socket, true);
+    sock->zerocopy.sends[socket]     = 0;
+    sock->zerocopy.completed[socket] = 0;
+    if (true == zerocopy) {
+        FD_SET(socket, &sock->zerocopy.fds);
+    } else {
+        FD_CLR(socket, &sock->zerocopy.fds);
+    }
+    sem_post(&sock->zerocopy.sem);
+
+    return ret;
+}
+
+/**
+ * @brief Send data of a sender to a socket, without copy if they are large enough
+ * @param sock Sock instance
+ * @param socket Socket
+ * @param worker Sender, its buffer is kept until the completions of the zero-copy sends are read
+ * @param buffer Data to be sent, part of the buffer of the sender
+ * @param size Size of data to send
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+sock_write(sock_t *sock, int socket, sock_worker_t *worker, void *buffer, size_t size) {
+
+    /* Small data are copied to the kernel, as well as the data sent to sockets on which zero-copy sends are not enabled */
+    bool zerocopy = false;
+    if ((0 < sock->options.zerocopy) && (size >= sock->options.zerocopy)) {
+        sem_wait(&sock->zerocopy.sem);
+        zerocopy = FD_ISSET(socket, &sock->zerocopy.fds);
+        sem_post(&sock->zerocopy.sem);
+    }
+
+    /* Prepare the tracking of the data in flight, the data are copied if it is not possible */
+    sock_zerocopy_t *z = NULL;
+    if ((true == zerocopy) && (NULL != (z = (sock_zerocopy_t *)malloc(sizeof(sock_zerocopy_t)))) && (NULL == worker->type.sender.hold)) {
+        if (NULL == (worker->type.sender.hold = (sock_hold_t *)malloc(sizeof(sock_hold_t)))) {
+            /* Unable to allocate memory */
+            free(z);
+            z = NULL;
+        } else {
+            worker->type.sender.hold->buffer   = worker->type.sender.buffer;
+            worker->type.sender.hold->refcount = 1;
+        }
+    }
+    if (NULL == z) {
+        return (size == send(socket, buffer, size, MSG_NOSIGNAL)) ? 0 : -1;
+    }
+
+    /* Send the data, the pages of the buffer are pinned by the kernel until they are acknowledged */
+    int      ret    = 0;
+    size_t   offset = 0;
+    uint32_t sends  = 0;
+    while ((0 == ret) && (offset < size)) {
+        ssize_t count = send(socket, (uint8_t *)buffer + offset, size - offset, MSG_NOSIGNAL | MSG_ZEROCOPY);
+        if ((0 > count) && (ENOBUFS == errno)) {
+            /* Unable to pin more pages, copy the remaining data */
+            ret = (size - offset == send(socket, (uint8_t *)buffer + offset, size - offset, MSG_NOSIGNAL)) ? 0 : -1;
+            break;
+        } else if (0 > count) {
             /* Unable to send data */
-            sem_wait(&sock->clients.sem);
-            FD_CLR(socket, &sock->clients.fds);
-            close(socket);
-            sem_post(&sock->clients.sem);
+            ret = -1;
+        } else {
+            offset += (size_t)count;
+            sends++;
         }
+    }
 
-        /* Increase Round-Robin index */
-        sem_wait(&sock->clients.sem);
-        sock->clients.index = (sock->clients.index + 1) % FD_SETSIZE;
-        sem_post(&sock->clients.sem);
+    /* Keep the buffer until the completions of the sends are read by the thread reading the socket, the sender does not wait for them */
+    sem_wait(&sock->zerocopy.sem);
+    if ((0 < sends) && (FD_ISSET(socket, &sock->zerocopy.fds))) {
+        sock->zerocopy.sends[socket] += sends;
+        z->socket = socket;
+        z->last   = sock->zerocopy.sends[socket] - 1;
+        z->hold   = worker->type.sender.hold;
+        z->hold->refcount++;
+        z->next              = sock->zerocopy.first;
+        sock->zerocopy.first = z;
+        z                    = NULL;
+    }
+    sem_post(&sock->zerocopy.sem);
+    free(z);
 
-    } else if (SOCK_SEND_BROADCAST == worker->type.sender.socket) {
+    return ret;
+}
 
-        /* Send data to all clients sockets */
-        sem_wait(&sock->clients.sem);
-        for (int index = 0; index < FD_SETSIZE; index++) {
-            if ((FD_ISSET(index, &sock->clients.fds))
-                && (worker->type.sender.size != send(index, worker->type.sender.buffer, worker->type.sender.size, MSG_NOSIGNAL))) {
-                /* Unable to send data */
-                FD_CLR(index, &sock->clients.fds);
-                close(index);
+/**
+ * @brief Send the data and the files of a sender to a socket
+ * @param sock Sock instance
+ * @param socket Socket
+ * @param worker Sender
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+sock_transmit(sock_t *sock, int socket, sock_worker_t *worker) {
+
+    uint8_t *buffer   = (uint8_t *)worker->type.sender.buffer;
+    size_t   position = 0;
+
+    /* Send the data between the files, they are pushed with the file data which follow them */
+    for (size_t index = 0; index < worker->type.sender.count; index++) {
+        sock_file_t *file = &worker->type.sender.files[index];
+        if ((position < file->position)
+            && ((ssize_t)(file->position - position) != send(socket, &buffer[position], file->position - position, MSG_NOSIGNAL | MSG_MORE))) {
+            /* Unable to send data */
+            return -1;
+        }
+        position = file->position;
+
+        /* Send the file data, the offset of the file descriptor is not modified */
+        off_t  offset = file->offset;
+        size_t size   = file->size;
+        while (0 < size) {
+            ssize_t count = sendfile(socket, file->fd, &offset, size);
+            if (0 >= count) {
+                /* Unable to send data or file truncated */
+                return -1;
             }
+            size -= (size_t)count;
         }
-        sem_post(&sock->clients.sem);
+    }
 
-    } else {
+    /* Send the remaining data */
+    return (position < worker->type.sender.size) ? sock_write(sock, socket, worker, &buffer[position], worker->type.sender.size - position) : 0;
+}
 
-        /* Send data to a single socket */
-        if (worker->type.sender.size != send(worker->type.sender.socket, worker->type.sender.buffer, worker->type.sender.size, MSG_NOSIGNAL)) {
-            /* Unable to send data */
-            sem_wait(&sock->clients.sem);
-            FD_CLR(worker->type.sender.socket, &sock->clients.fds);
-            close(worker->type.sender.socket);
-            sem_post(&sock->clients.sem);
+/**
+ * @brief Read the zero-copy completions of a socket without data to read, the data whose sends are completed are released
+ * @param sock Sock instance
+ * @param socket Socket
+ * @return true if the socket is still connected, false if it should be closed
+ */
+static bool
+sock_completions_read(sock_t *sock, int socket) {
+
+    uint8_t byte;
+
+    /* Check if zero-copy sends are enabled on the socket */
+    sem_wait(&sock->zerocopy.sem);
+    if (!FD_ISSET(socket, &sock->zerocopy.fds)) {
+        sem_post(&sock->zerocopy.sem);
+        return false;
+    }
+
+    /* Read the completions available, each one is a range of sends identifiers, the sends of a TCP socket are completed in order */
+    while (1) {
+        uint8_t       control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+        if (0 > recvmsg(socket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT)) {
+            /* No more completion */
+            break;
+        }
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); NULL != cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            struct sock_extended_err *err = (struct sock_extended_err *)CMSG_DATA(cmsg);
+            bool                      ipv4 = (SOL_IP == cmsg->cmsg_level) && (IP_RECVERR == cmsg->cmsg_type);
+            bool                      ipv6 = (SOL_IPV6 == cmsg->cmsg_level) && (IPV6_RECVERR == cmsg->cmsg_type);
+            if (((true == ipv4) || (true == ipv6)) && (SO_EE_ORIGIN_ZEROCOPY == err->ee_origin) && (0 < (int32_t)(err->ee_data + 1 - sock->zerocopy.completed[socket]))) {
+                /* Range of the sends completed, reported at the IPv4 or IPv6 level depending on the connection */
+                sock->zerocopy.completed[socket] = err->ee_data + 1;
+            }
         }
     }
 
-END:
+    /* Release the data whose sends are all completed */
+    sock_completions_release(sock, socket, false);
+    sem_post(&sock->zerocopy.sem);
 
-    /* Remove worker from senders */
-    sock_remove_worker(sock, &sock->senders, worker);
+    /* The socket is still connected if there is nothing to read */
+    return ((0 > recv(socket, &byte, sizeof(byte), MSG_PEEK | MSG_DONTWAIT)) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)));
+}
 
-    /* Release memory */
-    free(worker->type.sender.buffer);
-    free(worker);
+/**
+ * @brief Release the data sent without copy to a socket which is closed
+ * @param sock Sock instance
+ * @param socket Socket
+ */
+static void
+sock_completions_drop(sock_t *sock, int socket) {
+
+    /* The completions of the socket won't be read anymore */
+    sem_wait(&sock->zerocopy.sem);
+    if (FD_ISSET(socket, &sock->zerocopy.fds)) {
+        FD_CLR(socket, &sock->zerocopy.fds);
+        sock_completions_release(sock, socket, true);
+    }
+    sem_post(&sock->zerocopy.sem);
+}
 
-    return NULL;
+/**
+ * @brief Release the data in flight of a socket whose sends are completed, the semaphore of the zero-copy sends is held by the caller
+ * @param sock Sock instance
+ * @param socket Socket
+ * @param all true to release all the data in flight of the socket, false to release only the completed ones
+ */
+static void
+sock_completions_release(sock_t *sock, int socket, bool all) {
+
+    sock_zerocopy_t *prev = NULL;
+    sock_zerocopy_t *z    = sock->zerocopy.first;
+    while (NULL != z) {
+        sock_zerocopy_t *tmp = z;
+        z                    = z->next;
+        if ((socket == tmp->socket) && ((true == all) || (0 < (int32_t)(sock->zerocopy.completed[socket] - tmp->last)))) {
+            if (NULL == prev) {
+                sock->zerocopy.first = z;
+            } else {
+                prev->next = z;
+            }
+            sock_hold_release(tmp->hold);
+            free(tmp);
+        } else {
+            prev = tmp;
+        }
+    }
+}
+
+/**
+ * @brief Release a reference to the buffer of a sender, the semaphore of the zero-copy sends is held by the caller
+ * @param hold Buffer of the sender
+ */
+static void
+sock_hold_release(sock_hold_t *hold) {
+
+    /* Release the buffer once the last reference is dropped */
+    if (0 == --hold->refcount) {
+        free(hold->buffer);
+        free(hold);
+    }
+}
+
+/**
+ * @brief Release the buffer of a sender, it is kept until the completions of its zero-copy sends have been read
+ * @param sock Sock instance
+ * @param worker Sender
+ */
+static void
+sock_sender_release(sock_t *sock, sock_worker_t *worker) {
+
+    /* Release the reference of the sender, or the buffer itself if it has no zero-copy send in flight */
+    if (NULL != worker->type.sender.hold) {
+        sem_wait(&sock->zerocopy.sem);
+        sock_hold_release(worker->type.sender.hold);
+        sem_post(&sock->zerocopy.sem);
+    } else {
+        free(worker->type.sender.buffer);
+    }
 }
 
 /**
@@ -824,10 +2683,11 @@ END:
  * @param list List of workers to which the worker should be added
  * @param worker Worker to start
  * @param start_routine Worker thread function
+ * @param cpus CPUs on which the worker is running, NULL or empty set if it is not pinned
  * @return 0 if the function succeeded, -1 otherwise
  */
 static int
-sock_start_worker(sock_t *sock, sock_worker_list_t *list, sock_worker_t *worker, void *(*start_routine)(void *)) {
+sock_start_worker(sock_t *sock, sock_worker_list_t *list, sock_worker_t *worker, void *(*start_routine)(void *), cpu_set_t *cpus) {
 
     /* Wait semaphore */
     sem_wait(&list->sem);
@@ -839,13 +2699,18 @@ sock_start_worker(sock_t *sock, sock_worker_list_t *list, sock_worker_t *worker,
     pthread_attr_t attr;
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if ((NULL != cpus) && (0 < CPU_COUNT(cpus))) {
+        pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), cpus);
+    }
 
     /* Start thread */
     if (0 != pthread_create(&worker->thread, &attr, start_routine, (void *)worker)) {
         /* Unable to start the thread */
+        pthread_attr_destroy(&attr);
         sem_post(&list->sem);
         return -1;
     }
+    pthread_attr_destroy(&attr);
 
     /* Add worker to the daisy chain */
     if (NULL == list->last) {
@@ -894,3 +2759,17 @@ sock_remove_worker(sock_t *sock, sock_worker_list_t *list, sock_worker_t *worker
 
     return 0;
 }
+
+/**
+ * @brief Remove the file of a Unix domain socket, any other kind of file at this path is kept
+ * @param path Path of the socket
+ */
+static void
+sock_ipc_unlink(char *path) {
+
+    /* Check the kind of file without following a symbolic link */
+    struct stat st;
+    if ((0 == lstat(path, &st)) && (S_ISSOCK(st.st_mode))) {
+        unlink(path);
+    }
+}
@@ -0,0 +1,270 @@
+/**
+ * @file      stream.c
+ * @brief     Incremental parsing of the received frames, fields data are streamed to the callback
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "stream.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Invoke the stream callback of the Axon instance
+ * @param stream Stream parser
+ * @param axon Axon instance
+ * @param event Event
+ */
+static void stream_emit(stream_t *stream, axon_t *axon, axon_stream_event_e event);
+
+/**
+ * @brief Start the current field once its header and prefix are received
+ * @param stream Stream parser
+ * @param axon Axon instance
+ */
+static void stream_field(stream_t *stream, axon_t *axon);
+
+/**
+ * @brief Complete the current field, and the message if it was the last field
+ * @param stream Stream parser
+ * @param axon Axon instance
+ */
+static void stream_field_end(stream_t *stream, axon_t *axon);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a stream parser
+ * @return Stream parser if the function succeeded, NULL otherwise
+ */
+stream_t *
+stream_create(void) {
+
+    /* Create stream parser, waiting for a frame header */
+    stream_t *stream = (stream_t *)malloc(sizeof(stream_t));
+    if (NULL == stream) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(stream, 0, sizeof(stream_t));
+    stream->state = STREAM_STATE_HEADER;
+
+    return stream;
+}
+
+/**
+ * @brief Parse data received, the stream callback of the Axon instance is invoked as soon as the headers and the data of the fields are received
+ * @param stream Stream parser
+ * @param axon Axon instance
+ * @param data Data received
+ * @param size Size of the data
+ * @return 0 if the function succeeded, -1 if the data are not a valid frame, the current message is aborted in this case
+ */
+int
+stream_feed(stream_t *stream, axon_t *axon, uint8_t *data, size_t size) {
+
+    assert(NULL != stream);
+    assert(NULL != axon);
+    assert((NULL != data) || (0 == size));
+
+    /* Parse until all the data are consumed, a frame can be split anywhere between two receptions */
+    while (0 < size) {
+        switch (stream->state) {
+            case STREAM_STATE_HEADER:
+                /* Check the frame header and begin a new message */
+                if ((FRAME_VERSION != (data[0] >> 4)) || (0 == (data[0] & 0x0F))) {
+                    /* Invalid frame */
+                    return -1;
+                }
+                memset(&stream->event, 0, sizeof(axon_stream_t));
+                stream->event.count  = data[0] & 0x0F;
+                stream->pending_size = 0;
+                stream->state        = STREAM_STATE_FIELD_HEADER;
+                data += FRAME_HEADER_SIZE;
+                size -= FRAME_HEADER_SIZE;
+                stream_emit(stream, axon, AXON_STREAM_BEGIN);
+                break;
+            case STREAM_STATE_FIELD_HEADER:
+            case STREAM_STATE_PREFIX: {
+                /* Accumulate the field header or the prefix, they may be split between two receptions */
+                size_t wanted = (STREAM_STATE_FIELD_HEADER == stream->state) ? FRAME_FIELD_HEADER_SIZE : FRAME_PREFIX_SIZE;
+                size_t count  = (wanted - stream->pending_size < size) ? wanted - stream->pending_size : size;
+                memcpy(&stream->pending[stream->pending_size], data, count);
+                stream->pending_size += count;
+                data += count;
+                size -= count;
+                if (wanted > stream->pending_size) {
+                    break;
+                }
+                stream->pending_size = 0;
+                if (STREAM_STATE_PREFIX == stream->state) {
+                    /* Prefix received */
+                    stream_field(stream, axon);
+                    break;
+                }
+                /* Field header received, fields too small to have a prefix are blobs */
+                stream->length = ((size_t)stream->pending[0] << 24) | ((size_t)stream->pending[1] << 16) | ((size_t)stream->pending[2] << 8)
+                                 | (size_t)stream->pending[3];
+                if (FRAME_PREFIX_SIZE <= stream->length) {
+                    stream->state = STREAM_STATE_PREFIX;
+                } else {
+                    stream_field(stream, axon);
+                }
+                break;
+            }
+            case STREAM_STATE_DATA: {
+                /* Give the data of the field to the callback as they are received */
+                size_t count = (stream->remaining < size) ? stream->remaining : size;
+                stream->event.data   = data;
+                stream->event.length = count;
+                stream_emit(stream, axon, AXON_STREAM_DATA);
+                stream->event.offset += count;
+                stream->remaining -= count;
+                data += count;
+                size -= count;
+                if (0 == stream->remaining) {
+                    stream_field_end(stream, axon);
+                }
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Abort the current message if any, the stream parser waits for a new frame
+ * @param stream Stream parser
+ * @param axon Axon instance
+ */
+void
+stream_abort(stream_t *stream, axon_t *axon) {
+
+    assert(NULL != stream);
+    assert(NULL != axon);
+
+    /* The callback is notified only if a message has begun */
+    if (STREAM_STATE_HEADER != stream->state) {
+        stream_emit(stream, axon, AXON_STREAM_ABORT);
+    }
+    stream->state        = STREAM_STATE_HEADER;
+    stream->pending_size = 0;
+}
+
+/**
+ * @brief Release stream parser
+ * @param stream Stream parser
+ */
+void
+stream_release(stream_t *stream) {
+
+    /* Release stream parser */
+    if (NULL != stream) {
+        free(stream);
+    }
+}
+
+/**
+ * @brief Invoke the stream callback of the Axon instance
+ * @param stream Stream parser
+ * @param axon Axon instance
+ * @param event Event
+ */
+static void
+stream_emit(stream_t *stream, axon_t *axon, axon_stream_event_e event) {
+
+    /* Check if stream callback is defined */
+    if (NULL != axon->cb.stream.fct) {
+        stream->event.event = event;
+        axon->cb.stream.fct(axon, &stream->event, axon->cb.stream.user);
+    }
+    stream->event.data   = NULL;
+    stream->event.length = 0;
+}
+
+/**
+ * @brief Start the current field once its header and prefix are received
+ * @param stream Stream parser
+ * @param axon Axon instance
+ */
+static void
+stream_field(stream_t *stream, axon_t *axon) {
+
+    /* Retrieve the type of the field using the prefix */
+    frame_field_t field;
+    frame_field(stream->pending, (FRAME_PREFIX_SIZE <= stream->length) ? FRAME_PREFIX_SIZE : 0, &field);
+    stream->event.type   = field.type;
+    stream->event.size   = (AMP_TYPE_BLOB == field.type) ? stream->length : stream->length - FRAME_PREFIX_SIZE;
+    stream->event.offset = 0;
+    stream_emit(stream, axon, AXON_STREAM_FIELD);
+
+    /* The bytes read as a prefix are the beginning of the data of blobs */
+    stream->remaining = stream->event.size;
+    if ((AMP_TYPE_BLOB == field.type) && (FRAME_PREFIX_SIZE <= stream->length)) {
+        stream->event.data   = stream->pending;
+        stream->event.length = FRAME_PREFIX_SIZE;
+        stream_emit(stream, axon, AXON_STREAM_DATA);
+        stream->event.offset = FRAME_PREFIX_SIZE;
+        stream->remaining -= FRAME_PREFIX_SIZE;
+    }
+
+    /* Receive the data of the field */
+    stream->state = STREAM_STATE_DATA;
+    if (0 == stream->remaining) {
+        stream_field_end(stream, axon);
+    }
+}
+
+/**
+ * @brief Complete the current field, and the message if it was the last field
+ * @param stream Stream parser
+ * @param axon Axon instance
+ */
+static void
+stream_field_end(stream_t *stream, axon_t *axon) {
+
+    /* Wait for the next field header, or for the next frame if the message is complete */
+    stream->event.index++;
+    if (stream->event.index < stream->event.count) {
+        stream->state = STREAM_STATE_FIELD_HEADER;
+    } else {
+        stream->state = STREAM_STATE_HEADER;
+        stream_emit(stream, axon, AXON_STREAM_END);
+    }
+}
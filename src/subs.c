@@ -0,0 +1,764 @@
+/**
+ * @file      subs.c
+ * @brief     Handling of the topic subscriptions
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <sched.h>
+#include <regex.h>
+
+#include "subs.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Create a new subscriptions table
+ * @param count Amount of subscriptions
+ * @return Subscriptions table if the function succeeded, NULL otherwise
+ */
+static subs_table_t *subs_table_create(size_t count);
+
+/**
+ * @brief Index the subscriptions of a table, literals are added to the trie and regular expressions to a list
+ * @param table Subscriptions table
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int subs_table_index(subs_table_t *table);
+
+/**
+ * @brief Publish a new subscriptions table and release the previous one
+ * @param subs Subscriptions instance
+ * @param table New subscriptions table
+ */
+static void subs_table_publish(subs_t *subs, subs_table_t *table);
+
+/**
+ * @brief Execute a regular expression on a topic which is not necessarily null-terminated
+ * @param regex Compiled regular expression
+ * @param topic Topic
+ * @param size Size of the topic
+ * @return true if the topic matches, false otherwise
+ */
+static bool subs_regexec(regex_t *regex, char *topic, size_t size);
+
+/**
+ * @brief Compare two subscription indexes, used to sort the matching subscriptions
+ * @param a First index
+ * @param b Second index
+ * @return Negative, zero or positive value if the first index is lower, equal or greater than the second one
+ */
+static int subs_index_compare(const void *a, const void *b);
+
+/**
+ * @brief Create a new subscription
+ * @param topic Topic
+ * @param fct Callback funtion invoked with the decoded messages, NULL if the subscription is a view one
+ * @param view Callback funtion invoked with the messages viewed in the received buffer, NULL if the subscription is a decoded one
+ * @param user User data
+ * @param glob true if the topic is a glob pattern, false if it is a regular expression
+ * @return Subscription if the function succeeded, NULL otherwise
+ */
+static axon_sub_t *subs_sub_create(char *topic, void *fct, void *view, void *user, bool glob);
+
+/**
+ * @brief Extract the literal of a topic of the form [^][.*]literal[.*][$]
+ * @param sub Subscription
+ * @return 0 if the topic is a literal, -1 otherwise
+ */
+static int subs_sub_literal(axon_sub_t *sub);
+
+/**
+ * @brief Release a reference to a subscription
+ * @param sub Subscription
+ */
+static void subs_sub_release(axon_sub_t *sub);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create subscriptions instance
+ * @return Subscriptions instance if the function succeeded, NULL otherwise
+ */
+subs_t *
+subs_create(void) {
+
+    /* Create subscriptions instance */
+    subs_t *subs = (subs_t *)malloc(sizeof(subs_t));
+    if (NULL == subs) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(subs, 0, sizeof(subs_t));
+
+    /* Create an empty table */
+    subs_table_t *table = subs_table_create(0);
+    if (NULL == table) {
+        /* Unable to allocate memory */
+        free(subs);
+        return NULL;
+    }
+    atomic_init(&subs->table, table);
+    atomic_init(&subs->readers, 0);
+
+    /* The match cache is created with the first subscription */
+    atomic_init(&subs->cache, NULL);
+    subs->cache_size = SUBS_CACHE_SIZE;
+
+    /* Initialize semaphore used to serialize updates */
+    sem_init(&subs->sem, 0, 1);
+
+    return subs;
+}
+
+/**
+ * @brief Set the amount of topics kept in the match cache, should be called before subscribing
+ * @param subs Subscriptions instance
+ * @param size Amount of topics, 0 to disable the cache
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+subs_set_cache(subs_t *subs, size_t size) {
+
+    assert(NULL != subs);
+
+    int ret = 0;
+
+    /* Wait semaphore */
+    sem_wait(&subs->sem);
+
+    /* The size can not be changed once the cache is used by dispatching threads */
+    if (NULL != atomic_load(&subs->cache)) {
+        ret = -1;
+    } else {
+        subs->cache_size = size;
+    }
+
+    /* Release semaphore */
+    sem_post(&subs->sem);
+
+    return ret;
+}
+
+/**
+ * @brief Add a subscription or update the existing one
+ * @param subs Subscriptions instance
+ * @param topic Topic
+ * @param fct Callback funtion invoked with the decoded messages, NULL if the subscription is a view one
+ * @param view Callback funtion invoked with the messages viewed in the received buffer, NULL if the subscription is a decoded one
+ * @param user User data
+ * @param glob true if the topic is a glob pattern, false if it is a regular expression
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+subs_add(subs_t *subs, char *topic, void *fct, void *view, void *user, bool glob) {
+
+    assert(NULL != subs);
+    assert(NULL != topic);
+
+    int ret = 0;
+
+    /* Wait semaphore */
+    sem_wait(&subs->sem);
+
+    /* Create the match cache, it is published with the table so that dispatching threads see it with the first subscription */
+    if ((0 < subs->cache_size) && (NULL == atomic_load(&subs->cache))) {
+        atomic_store(&subs->cache, cache_create(subs->cache_size));
+    }
+
+    /* Create the subscription */
+    axon_sub_t *sub = subs_sub_create(topic, fct, view, user, glob);
+    if (NULL == sub) {
+        /* Unable to allocate memory */
+        ret = -1;
+        goto LEAVE;
+    }
+
+    /* Search the topic in the current table, the writer is the only one allowed to access it without acquiring it */
+    subs_table_t *curr  = atomic_load(&subs->table);
+    size_t        found = curr->count;
+    for (size_t index = 0; index < curr->count; index++) {
+        if (!strcmp(topic, curr->subs[index]->topic)) {
+            found = index;
+            break;
+        }
+    }
+
+    /* Copy the current table, replacing the subscription if the topic is found or adding it at the end otherwise */
+    subs_table_t *table = subs_table_create((found < curr->count) ? curr->count : (curr->count + 1));
+    if (NULL == table) {
+        /* Unable to allocate memory */
+        subs_sub_release(sub);
+        ret = -1;
+        goto LEAVE;
+    }
+    for (size_t index = 0; index < curr->count; index++) {
+        if (index != found) {
+            table->subs[index] = curr->subs[index];
+            atomic_fetch_add(&table->subs[index]->refcount, 1);
+        }
+    }
+    table->subs[(found < curr->count) ? found : curr->count] = sub;
+
+    /* Index the subscriptions */
+    if (0 != subs_table_index(table)) {
+        /* Unable to allocate memory */
+        subs_table_release(table);
+        ret = -1;
+        goto LEAVE;
+    }
+
+    /* Publish the new table */
+    subs_table_publish(subs, table);
+
+LEAVE:
+
+    /* Release semaphore */
+    sem_post(&subs->sem);
+
+    return ret;
+}
+
+/**
+ * @brief Remove a subscription
+ * @param subs Subscriptions instance
+ * @param topic Topic
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+subs_remove(subs_t *subs, char *topic) {
+
+    assert(NULL != subs);
+    assert(NULL != topic);
+
+    int ret = 0;
+
+    /* Wait semaphore */
+    sem_wait(&subs->sem);
+
+    /* Search the topic in the current table */
+    subs_table_t *curr  = atomic_load(&subs->table);
+    size_t        found = curr->count;
+    for (size_t index = 0; index < curr->count; index++) {
+        if (!strcmp(topic, curr->subs[index]->topic)) {
+            found = index;
+            break;
+        }
+    }
+    if (found == curr->count) {
+        /* Subscription not found */
+        goto LEAVE;
+    }
+
+    /* Copy the current table without the subscription */
+    subs_table_t *table = subs_table_create(curr->count - 1);
+    if (NULL == table) {
+        /* Unable to allocate memory */
+        ret = -1;
+        goto LEAVE;
+    }
+    for (size_t index = 0, count = 0; index < curr->count; index++) {
+        if (index != found) {
+            table->subs[count] = curr->subs[index];
+            atomic_fetch_add(&table->subs[count]->refcount, 1);
+            count++;
+        }
+    }
+
+    /* Index the subscriptions */
+    if (0 != subs_table_index(table)) {
+        /* Unable to allocate memory */
+        subs_table_release(table);
+        ret = -1;
+        goto LEAVE;
+    }
+
+    /* Publish the new table */
+    subs_table_publish(subs, table);
+
+LEAVE:
+
+    /* Release semaphore */
+    sem_post(&subs->sem);
+
+    return ret;
+}
+
+/**
+ * @brief Acquire the current subscriptions table, it remains valid until it is released even if subscriptions are updated meanwhile
+ * @param subs Subscriptions instance
+ * @return Subscriptions table
+ */
+subs_table_t *
+subs_table_acquire(subs_t *subs) {
+
+    assert(NULL != subs);
+
+    /* Retrieve the current table and take a reference, the writer waits for readers before releasing a table it has replaced */
+    atomic_fetch_add(&subs->readers, 1);
+    subs_table_t *table = atomic_load(&subs->table);
+    atomic_fetch_add(&table->refcount, 1);
+    atomic_fetch_sub(&subs->readers, 1);
+
+    return table;
+}
+
+/**
+ * @brief Search the subscriptions matching a topic
+ * @param table Subscriptions table
+ * @param topic Topic, not necessarily null-terminated
+ * @param size Size of the topic
+ * @param matches Array of at least table->count entries filled with the indexes of the matching subscriptions, in subscription order
+ * @return Amount of matching subscriptions
+ */
+size_t
+subs_table_match(subs_table_t *table, char *topic, size_t size, size_t *matches) {
+
+    assert(NULL != table);
+    assert(NULL != topic);
+    assert(NULL != matches);
+
+    size_t count = 0;
+
+    /* Search all the literals with a single pass on the topic */
+    if (NULL != table->trie) {
+        count = trie_match(table->trie, topic, size, matches, count);
+    }
+
+    /* Search all the regular expressions compiled to a NFA with a single pass on the topic, they are executed if the automaton is too large */
+    if ((NULL != table->dfa) && (0 != dfa_match(table->dfa, topic, size, matches, &count))) {
+        for (size_t index = 0; index < table->count; index++) {
+            if ((NULL != table->subs[index]->nfa) && (true == subs_regexec(&table->subs[index]->regex, topic, size))) {
+                matches[count++] = index;
+            }
+        }
+    }
+
+    /* Match the glob patterns */
+    for (size_t index = 0; index < table->wildcards_count; index++) {
+        if (true == wildcard_match(table->subs[table->wildcards[index]]->wildcard, topic, size)) {
+            matches[count++] = table->wildcards[index];
+        }
+    }
+
+    /* Execute the other regular expressions */
+    for (size_t index = 0; index < table->regexes_count; index++) {
+        if (true == subs_regexec(&table->subs[table->regexes[index]]->regex, topic, size)) {
+            matches[count++] = table->regexes[index];
+        }
+    }
+
+    /* Callbacks are invoked in subscription order */
+    if (1 < count) {
+        qsort(matches, count, sizeof(size_t), subs_index_compare);
+    }
+
+    return count;
+}
+
+/**
+ * @brief Search the subscriptions matching a topic, using the match cache when the topic has already been received with the same table generation
+ * @param subs Subscriptions instance
+ * @param table Subscriptions table acquired from the subscriptions instance
+ * @param topic Topic, not necessarily null-terminated
+ * @param size Size of the topic
+ * @param matches Array of at least table->count entries filled with the indexes of the matching subscriptions, in subscription order
+ * @return Amount of matching subscriptions
+ */
+size_t
+subs_match(subs_t *subs, subs_table_t *table, char *topic, size_t size, size_t *matches) {
+
+    assert(NULL != subs);
+    assert(NULL != table);
+    assert(NULL != topic);
+    assert(NULL != matches);
+
+    size_t count = 0;
+
+    /* Search the topic in the cache, matches computed with a previous table are not valid anymore */
+    cache_t *cache = atomic_load(&subs->cache);
+    if ((NULL != cache) && (true == cache_lookup(cache, table->generation, topic, size, matches, &count))) {
+        return count;
+    }
+
+    /* Search the matching subscriptions and store them for the next time the topic is received, the cache is not mandatory */
+    count = subs_table_match(table, topic, size, matches);
+    if (NULL != cache) {
+        cache_insert(cache, table->generation, topic, size, matches, count);
+    }
+
+    return count;
+}
+
+/**
+ * @brief Release a subscriptions table
+ * @param table Subscriptions table
+ */
+void
+subs_table_release(subs_table_t *table) {
+
+    /* Release the table once the last reference is dropped */
+    if ((NULL != table) && (1 == atomic_fetch_sub(&table->refcount, 1))) {
+        for (size_t index = 0; index < table->count; index++) {
+            subs_sub_release(table->subs[index]);
+        }
+        trie_release(table->trie);
+        dfa_release(table->dfa);
+        free(table->regexes);
+        free(table->wildcards);
+        free(table->subs);
+        free(table);
+    }
+}
+
+/**
+ * @brief Release subscriptions instance
+ * @param subs Subscriptions instance
+ */
+void
+subs_release(subs_t *subs) {
+
+    /* Release subscriptions instance */
+    if (NULL != subs) {
+
+        /* Release the current table */
+        subs_table_release(atomic_load(&subs->table));
+
+        /* Release the match cache */
+        cache_release(atomic_load(&subs->cache));
+
+        /* Release semaphore */
+        sem_close(&subs->sem);
+
+        /* Release subscriptions instance */
+        free(subs);
+    }
+}
+
+/**
+ * @brief Create a new subscriptions table
+ * @param count Amount of subscriptions
+ * @return Subscriptions table if the function succeeded, NULL otherwise
+ */
+static subs_table_t *
+subs_table_create(size_t count) {
+
+    /* Create new table */
+    subs_table_t *table = (subs_table_t *)malloc(sizeof(subs_table_t));
+    if (NULL == table) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(table, 0, sizeof(subs_table_t));
+    atomic_init(&table->refcount, 1);
+
+    /* Create subscriptions array */
+    if (0 < count) {
+        table->subs = (axon_sub_t **)malloc(count * sizeof(axon_sub_t *));
+        if (NULL == table->subs) {
+            /* Unable to allocate memory */
+            free(table);
+            return NULL;
+        }
+        memset(table->subs, 0, count * sizeof(axon_sub_t *));
+    }
+    table->count = count;
+
+    return table;
+}
+
+/**
+ * @brief Index the subscriptions of a table, literals are added to the trie and regular expressions to a list
+ * @param table Subscriptions table
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+static int
+subs_table_index(subs_table_t *table) {
+
+    /* Create regular expressions and glob patterns lists */
+    if (0 < table->count) {
+        table->regexes   = (size_t *)malloc(table->count * sizeof(size_t));
+        table->wildcards = (size_t *)malloc(table->count * sizeof(size_t));
+        if ((NULL == table->regexes) || (NULL == table->wildcards)) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+    }
+
+    /* Parse all subscriptions */
+    for (size_t index = 0; index < table->count; index++) {
+        axon_sub_t *sub = table->subs[index];
+        if (NULL != sub->nfa) {
+            if ((NULL == table->dfa) && (NULL == (table->dfa = dfa_create()))) {
+                /* Unable to allocate memory */
+                return -1;
+            }
+            if (0 != dfa_add(table->dfa, sub->nfa, index)) {
+                /* Unable to allocate memory */
+                return -1;
+            }
+        } else if (NULL != sub->wildcard) {
+            table->wildcards[table->wildcards_count++] = index;
+        } else if (NULL == sub->literal) {
+            table->regexes[table->regexes_count++] = index;
+        } else {
+            if ((NULL == table->trie) && (NULL == (table->trie = trie_create()))) {
+                /* Unable to allocate memory */
+                return -1;
+            }
+            if (0 != trie_add(table->trie, sub->literal, sub->size, sub->flags, index)) {
+                /* Unable to allocate memory */
+                return -1;
+            }
+        }
+    }
+
+    /* Build the trie */
+    if ((NULL != table->trie) && (0 != trie_build(table->trie))) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    /* Build the automaton */
+    if ((NULL != table->dfa) && (0 != dfa_build(table->dfa))) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Publish a new subscriptions table and release the previous one
+ * @param subs Subscriptions instance
+ * @param table New subscriptions table
+ */
+static void
+subs_table_publish(subs_t *subs, subs_table_t *table) {
+
+    /* Replace the current table, the new generation invalidates the topics stored in the match cache */
+    table->generation  = ++subs->generation;
+    subs_table_t *prev = atomic_exchange(&subs->table, table);
+
+    /* Wait for the readers which may have loaded the previous table without having taken their reference yet */
+    while (0 != atomic_load(&subs->readers)) {
+        sched_yield();
+    }
+
+    /* Release the reference of the previous table, it is freed once the readers still using it release it */
+    subs_table_release(prev);
+}
+
+/**
+ * @brief Execute a regular expression on a topic which is not necessarily null-terminated
+ * @param regex Compiled regular expression
+ * @param topic Topic
+ * @param size Size of the topic
+ * @return true if the topic matches, false otherwise
+ */
+static bool
+subs_regexec(regex_t *regex, char *topic, size_t size) {
+
+    /* The topic is delimited by the first match offsets so that it can be a view in the received buffer */
+    regmatch_t match = { 0, (regoff_t)size };
+
+    return (0 == regexec(regex, topic, 1, &match, REG_STARTEND));
+}
+
+/**
+ * @brief Compare two subscription indexes, used to sort the matching subscriptions
+ * @param a First index
+ * @param b Second index
+ * @return Negative, zero or positive value if the first index is lower, equal or greater than the second one
+ */
+static int
+subs_index_compare(const void *a, const void *b) {
+
+    size_t index_a = *(const size_t *)a;
+    size_t index_b = *(const size_t *)b;
+
+    return (index_a > index_b) - (index_a < index_b);
+}
+
+/**
+ * @brief Create a new subscription
+ * @param topic Topic
+ * @param fct Callback funtion invoked with the decoded messages, NULL if the subscription is a view one
+ * @param view Callback funtion invoked with the messages viewed in the received buffer, NULL if the subscription is a decoded one
+ * @param user User data
+ * @param glob true if the topic is a glob pattern, false if it is a regular expression
+ * @return Subscription if the function succeeded, NULL otherwise
+ */
+static axon_sub_t *
+subs_sub_create(char *topic, void *fct, void *view, void *user, bool glob) {
+
+    /* Create new subscription */
+    axon_sub_t *sub = (axon_sub_t *)malloc(sizeof(axon_sub_t));
+    if (NULL == sub) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(sub, 0, sizeof(axon_sub_t));
+    if (NULL == (sub->topic = strdup(topic))) {
+        /* Unable to allocate memory */
+        free(sub);
+        return NULL;
+    }
+    sub->fct  = fct;
+    sub->view = view;
+    sub->user = user;
+    atomic_init(&sub->refcount, 1);
+
+    /* Glob patterns with a single segment are searched using the trie, others are compiled once */
+    if (true == glob) {
+        if (NULL == (sub->wildcard = wildcard_create(topic))) {
+            /* Unable to allocate memory */
+            free(sub->topic);
+            free(sub);
+            return NULL;
+        }
+        if ((1 == sub->wildcard->count) && (1 >= sub->wildcard->segments[0].gap) && (1 >= sub->wildcard->tail)) {
+            sub->literal                    = sub->wildcard->segments[0].data;
+            sub->size                       = sub->wildcard->segments[0].size;
+            sub->flags                      = ((0 == sub->wildcard->segments[0].gap) ? TRIE_ANCHOR_START : TRIE_NOT_START)
+                                              | ((0 == sub->wildcard->tail) ? TRIE_ANCHOR_END : TRIE_NOT_END);
+            sub->wildcard->segments[0].data = NULL;
+            wildcard_release(sub->wildcard);
+            sub->wildcard = NULL;
+        }
+        return sub;
+    }
+
+    /* Literal topics are searched using the trie, others are compiled once */
+    if (0 != subs_sub_literal(sub)) {
+        if (0 != regcomp(&sub->regex, topic, REG_NOSUB | REG_EXTENDED)) {
+            /* Invalid regular expression */
+            free(sub->topic);
+            free(sub);
+            return NULL;
+        }
+
+        /* The regular expression is also compiled to a NFA so that it is matched with the others at once, regexec is used if its syntax is not supported */
+        sub->nfa = nfa_create(topic);
+    }
+
+    return sub;
+}
+
+/**
+ * @brief Extract the literal of a topic of the form [^][.*]literal[.*][$]
+ * @param sub Subscription
+ * @return 0 if the topic is a literal, -1 otherwise
+ */
+static int
+subs_sub_literal(axon_sub_t *sub) {
+
+    char *pattern = sub->topic;
+    int   flags   = 0;
+
+    /* Leading anchor, cancelled by a leading wildcard */
+    if ('^' == *pattern) {
+        flags |= TRIE_ANCHOR_START;
+        pattern++;
+    }
+    if (!strncmp(pattern, ".*", 2)) {
+        flags &= ~TRIE_ANCHOR_START;
+        pattern += 2;
+    }
+
+    /* Decode the literal, escaped metacharacters are part of it */
+    char *literal = (char *)malloc(strlen(pattern) + 1);
+    if (NULL == literal) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    size_t size = 0;
+    while ('\0' != *pattern) {
+        if (NULL == strchr(NFA_METACHARACTERS, *pattern)) {
+            literal[size++] = *pattern++;
+        } else if (('\\' == pattern[0]) && ('\0' != pattern[1]) && (NULL != strchr(NFA_METACHARACTERS, pattern[1]))) {
+            literal[size++] = pattern[1];
+            pattern += 2;
+        } else {
+            break;
+        }
+    }
+
+    /* Trailing anchor, cancelled by a trailing wildcard */
+    bool wildcard = !strncmp(pattern, ".*", 2);
+    if (wildcard) {
+        pattern += 2;
+    }
+    if ('$' == *pattern) {
+        if (!wildcard) {
+            flags |= TRIE_ANCHOR_END;
+        }
+        pattern++;
+    }
+
+    /* The whole topic must have been parsed and the literal must not be empty */
+    if ((0 == size) || ('\0' != *pattern)) {
+        free(literal);
+        return -1;
+    }
+    sub->literal = literal;
+    sub->size    = size;
+    sub->flags   = flags;
+
+    return 0;
+}
+
+/**
+ * @brief Release a reference to a subscription
+ * @param sub Subscription
+ */
+static void
+subs_sub_release(axon_sub_t *sub) {
+
+    /* Release the subscription once the last reference is dropped */
+    if ((NULL != sub) && (1 == atomic_fetch_sub(&sub->refcount, 1))) {
+        if (NULL != sub->literal) {
+            free(sub->literal);
+        } else if (NULL != sub->wildcard) {
+            wildcard_release(sub->wildcard);
+        } else {
+            regfree(&sub->regex);
+            nfa_release(sub->nfa);
+        }
+        free(sub->topic);
+        free(sub);
+    }
+}
@@ -0,0 +1,328 @@
+/**
+ * @file      trie.c
+ * @brief     Topic trie used to match literal subscriptions
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "trie.h"
+
+/******************************************************************************/
+/* Prototypes                                                                 */
+/******************************************************************************/
+
+/**
+ * @brief Retrieve the child of a node
+ * @param trie Trie instance
+ * @param node Node
+ * @param c Character leading to the child
+ * @return Child node, -1 if there is no such child
+ */
+static int trie_child(trie_t *trie, int node, unsigned char c);
+
+/**
+ * @brief Create a new node
+ * @param trie Trie instance
+ * @param parent Parent node
+ * @param c Character leading to the new node
+ * @return New node if the function succeeded, -1 otherwise
+ */
+static int trie_node_create(trie_t *trie, int parent, unsigned char c);
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to create a trie instance
+ * @return Trie instance if the function succeeded, NULL otherwise
+ */
+trie_t *
+trie_create(void) {
+
+    /* Create trie instance */
+    trie_t *trie = (trie_t *)malloc(sizeof(trie_t));
+    if (NULL == trie) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(trie, 0, sizeof(trie_t));
+    for (int index = 0; index < 256; index++) {
+        trie->root[index] = -1;
+    }
+
+    /* Create the root node */
+    trie->capacity = 64;
+    trie->nodes    = (trie_node_t *)malloc(trie->capacity * sizeof(trie_node_t));
+    if (NULL == trie->nodes) {
+        /* Unable to allocate memory */
+        free(trie);
+        return NULL;
+    }
+    trie->nodes[0].child   = -1;
+    trie->nodes[0].sibling = -1;
+    trie->nodes[0].fail    = 0;
+    trie->nodes[0].dict    = -1;
+    trie->nodes[0].output  = -1;
+    trie->nodes[0].c       = 0;
+    trie->count            = 1;
+
+    return trie;
+}
+
+/**
+ * @brief Add a pattern to the trie, trie_build must be called once all the patterns are added
+ * @param trie Trie instance
+ * @param pattern Pattern
+ * @param size Size of the pattern, must not be 0
+ * @param flags Pattern flags
+ * @param index Index returned when the pattern matches
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+trie_add(trie_t *trie, char *pattern, size_t size, int flags, size_t index) {
+
+    assert(NULL != trie);
+    assert(NULL != pattern);
+    assert(0 < size);
+
+    /* Walk the pattern, creating the missing nodes */
+    int node = 0;
+    for (size_t offset = 0; offset < size; offset++) {
+        int child = trie_child(trie, node, (unsigned char)pattern[offset]);
+        if (0 > child) {
+            if (0 > (child = trie_node_create(trie, node, (unsigned char)pattern[offset]))) {
+                /* Unable to allocate memory */
+                return -1;
+            }
+        }
+        node = child;
+    }
+
+    /* Add the output to the last node */
+    if (trie->outputs_count == trie->outputs_capacity) {
+        size_t         capacity = (0 < trie->outputs_capacity) ? (2 * trie->outputs_capacity) : 16;
+        trie_output_t *outputs  = (trie_output_t *)realloc(trie->outputs, capacity * sizeof(trie_output_t));
+        if (NULL == outputs) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        trie->outputs          = outputs;
+        trie->outputs_capacity = capacity;
+    }
+    trie->outputs[trie->outputs_count].index = index;
+    trie->outputs[trie->outputs_count].size  = size;
+    trie->outputs[trie->outputs_count].flags = flags;
+    trie->outputs[trie->outputs_count].next  = trie->nodes[node].output;
+    trie->nodes[node].output                 = (int)trie->outputs_count;
+    trie->outputs_count++;
+
+    return 0;
+}
+
+/**
+ * @brief Build the links of the trie
+ * @param trie Trie instance
+ * @return 0 if the function succeeded, -1 otherwise
+ */
+int
+trie_build(trie_t *trie) {
+
+    assert(NULL != trie);
+
+    /* Nodes are visited in breadth-first order so that the links of the shorter suffixes are known */
+    int *queue = (int *)malloc(trie->count * sizeof(int));
+    if (NULL == queue) {
+        /* Unable to allocate memory */
+        return -1;
+    }
+    size_t head = 0, tail = 0;
+
+    /* Children of the root node fall back to the root node */
+    for (int child = trie->nodes[0].child; 0 <= child; child = trie->nodes[child].sibling) {
+        trie->nodes[child].fail = 0;
+        trie->nodes[child].dict = -1;
+        queue[tail++]           = child;
+    }
+
+    /* Other nodes fall back to the longest suffix of their parent followed by their character */
+    while (head < tail) {
+        int node = queue[head++];
+        for (int child = trie->nodes[node].child; 0 <= child; child = trie->nodes[child].sibling) {
+            int fail = trie->nodes[node].fail;
+            int next = trie_child(trie, fail, trie->nodes[child].c);
+            while ((0 > next) && (0 != fail)) {
+                fail = trie->nodes[fail].fail;
+                next = trie_child(trie, fail, trie->nodes[child].c);
+            }
+            trie->nodes[child].fail = (0 <= next) ? next : 0;
+            trie->nodes[child].dict = (0 <= trie->nodes[trie->nodes[child].fail].output) ? trie->nodes[child].fail : trie->nodes[trie->nodes[child].fail].dict;
+            queue[tail++]           = child;
+        }
+    }
+
+    /* Release memory */
+    free(queue);
+
+    return 0;
+}
+
+/**
+ * @brief Search all the patterns of the trie in the topic
+ * @param trie Trie instance
+ * @param topic Topic
+ * @param size Size of the topic
+ * @param matches Array to which the indexes of the matching patterns are appended, each index is appended only once
+ * @param count Amount of indexes already present in the array
+ * @return Amount of indexes in the array
+ */
+size_t
+trie_match(trie_t *trie, char *topic, size_t size, size_t *matches, size_t count) {
+
+    assert(NULL != trie);
+    assert(NULL != topic);
+    assert(NULL != matches);
+
+    int node = 0;
+
+    /* Single pass on the topic */
+    for (size_t offset = 0; offset < size; offset++) {
+
+        /* Follow the failure links until the character can be consumed */
+        unsigned char c    = (unsigned char)topic[offset];
+        int           next = trie_child(trie, node, c);
+        while ((0 > next) && (0 != node)) {
+            node = trie->nodes[node].fail;
+            next = trie_child(trie, node, c);
+        }
+        node = (0 <= next) ? next : 0;
+
+        /* Check all the patterns ending at this offset */
+        for (int curr = (0 <= trie->nodes[node].output) ? node : trie->nodes[node].dict; 0 < curr; curr = trie->nodes[curr].dict) {
+            for (int output = trie->nodes[curr].output; 0 <= output; output = trie->outputs[output].next) {
+                trie_output_t *o = &trie->outputs[output];
+                if (((0 != (o->flags & TRIE_ANCHOR_START)) && (offset + 1 != o->size)) || ((0 != (o->flags & TRIE_ANCHOR_END)) && (offset + 1 != size))
+                    || ((0 != (o->flags & TRIE_NOT_START)) && (offset + 1 == o->size)) || ((0 != (o->flags & TRIE_NOT_END)) && (offset + 1 == size))) {
+                    /* Pattern found at a wrong position */
+                    continue;
+                }
+                size_t index = 0;
+                while ((index < count) && (matches[index] != o->index)) {
+                    index++;
+                }
+                if (index == count) {
+                    matches[count++] = o->index;
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Release trie instance
+ * @param trie Trie instance
+ */
+void
+trie_release(trie_t *trie) {
+
+    /* Release trie instance */
+    if (NULL != trie) {
+        free(trie->nodes);
+        free(trie->outputs);
+        free(trie);
+    }
+}
+
+/**
+ * @brief Retrieve the child of a node
+ * @param trie Trie instance
+ * @param node Node
+ * @param c Character leading to the child
+ * @return Child node, -1 if there is no such child
+ */
+static int
+trie_child(trie_t *trie, int node, unsigned char c) {
+
+    /* Children of the root node are indexed */
+    if (0 == node) {
+        return trie->root[c];
+    }
+
+    /* Parse children */
+    for (int child = trie->nodes[node].child; 0 <= child; child = trie->nodes[child].sibling) {
+        if (c == trie->nodes[child].c) {
+            return child;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Create a new node
+ * @param trie Trie instance
+ * @param parent Parent node
+ * @param c Character leading to the new node
+ * @return New node if the function succeeded, -1 otherwise
+ */
+static int
+trie_node_create(trie_t *trie, int parent, unsigned char c) {
+
+    /* Grow the nodes array if it is full */
+    if (trie->count == trie->capacity) {
+        trie_node_t *nodes = (trie_node_t *)realloc(trie->nodes, 2 * trie->capacity * sizeof(trie_node_t));
+        if (NULL == nodes) {
+            /* Unable to allocate memory */
+            return -1;
+        }
+        trie->nodes    = nodes;
+        trie->capacity = 2 * trie->capacity;
+    }
+
+    /* Initialize the node and add it to the children of its parent */
+    int node                  = (int)trie->count++;
+    trie->nodes[node].child   = -1;
+    trie->nodes[node].sibling = trie->nodes[parent].child;
+    trie->nodes[node].fail    = 0;
+    trie->nodes[node].dict    = -1;
+    trie->nodes[node].output  = -1;
+    trie->nodes[node].c       = c;
+    trie->nodes[parent].child = node;
+    if (0 == parent) {
+        trie->root[c] = node;
+    }
+
+    return node;
+}
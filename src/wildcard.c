@@ -0,0 +1,160 @@
+/**
+ * @file      wildcard.c
+ * @brief     Glob patterns compatible with Node axon topics
+ *
+ * MIT License
+ *
+ * Copyright (c) 2021-2023 joelguittet and c-axon contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "wildcard.h"
+
+/******************************************************************************/
+/* Functions                                                                  */
+/******************************************************************************/
+
+/**
+ * @brief Function used to compile a glob pattern to a wildcard instance
+ * The pattern matches the whole topic, '*' matches one or more characters and all the other characters are literals as in Node axon.
+ * @param pattern Glob pattern
+ * @return Wildcard instance if the function succeeded, NULL otherwise
+ */
+wildcard_t *
+wildcard_create(char *pattern) {
+
+    assert(NULL != pattern);
+
+    /* Create wildcard instance */
+    wildcard_t *wildcard = (wildcard_t *)malloc(sizeof(wildcard_t));
+    if (NULL == wildcard) {
+        /* Unable to allocate memory */
+        return NULL;
+    }
+    memset(wildcard, 0, sizeof(wildcard_t));
+
+    /* Create segments array, there are at most one more segments than wildcards */
+    size_t count = 1;
+    for (char *curr = pattern; '\0' != *curr; curr++) {
+        count += ('*' == *curr) ? 1 : 0;
+    }
+    wildcard->segments = (wildcard_segment_t *)malloc(count * sizeof(wildcard_segment_t));
+    if (NULL == wildcard->segments) {
+        /* Unable to allocate memory */
+        free(wildcard);
+        return NULL;
+    }
+
+    /* Split the pattern on its wildcards, consecutive wildcards are counted in the gap of the next segment */
+    size_t gap = 0;
+    while ('\0' != *pattern) {
+        if ('*' == *pattern) {
+            gap++;
+            pattern++;
+        } else {
+            size_t size = strcspn(pattern, "*");
+            if (NULL == (wildcard->segments[wildcard->count].data = (char *)malloc(size))) {
+                /* Unable to allocate memory */
+                wildcard_release(wildcard);
+                return NULL;
+            }
+            memcpy(wildcard->segments[wildcard->count].data, pattern, size);
+            wildcard->segments[wildcard->count].size = size;
+            wildcard->segments[wildcard->count].gap  = gap;
+            wildcard->count++;
+            gap = 0;
+            pattern += size;
+        }
+    }
+    wildcard->tail = gap;
+
+    return wildcard;
+}
+
+/**
+ * @brief Check if a topic matches the glob pattern
+ * @param wildcard Wildcard instance
+ * @param topic Topic
+ * @param size Size of the topic
+ * @return true if the topic matches, false otherwise
+ */
+bool
+wildcard_match(wildcard_t *wildcard, char *topic, size_t size) {
+
+    assert(NULL != wildcard);
+    assert(NULL != topic);
+
+    size_t offset = 0;
+
+    /* Search the segments in order, the leftmost occurrence of each segment leaves the most characters to the next ones */
+    for (size_t index = 0; index < wildcard->count; index++) {
+        wildcard_segment_t *segment = &wildcard->segments[index];
+        size_t              start;
+        if (size < offset + segment->gap + segment->size) {
+            /* Topic too short */
+            return false;
+        }
+        if ((0 == segment->gap) || ((index == wildcard->count - 1) && (0 == wildcard->tail))) {
+            /* First segment without wildcard before it or last segment without wildcard after it, it must be at the beginning or at the end of the topic */
+            start = (0 == segment->gap) ? offset : (size - segment->size);
+            if (0 != memcmp(topic + start, segment->data, segment->size)) {
+                return false;
+            }
+        } else {
+            /* Search the leftmost occurrence of the segment after its wildcards */
+            char *found = memmem(topic + offset + segment->gap, size - offset - segment->gap, segment->data, segment->size);
+            if (NULL == found) {
+                return false;
+            }
+            start = (size_t)(found - topic);
+        }
+        offset = start + segment->size;
+    }
+
+    /* Check the end of the topic matches the wildcards after the last segment */
+    return (0 == wildcard->tail) ? (offset == size) : (size - offset >= wildcard->tail);
+}
+
+/**
+ * @brief Release wildcard instance
+ * @param wildcard Wildcard instance
+ */
+void
+wildcard_release(wildcard_t *wildcard) {
+
+    /* Release wildcard instance */
+    if (NULL != wildcard) {
+        for (size_t index = 0; index < wildcard->count; index++) {
+            free(wildcard->segments[index].data);
+        }
+        free(wildcard->segments);
+        free(wildcard);
+    }
+}